@@ -6,17 +6,36 @@
  */
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <numeric>
 #include <random>
 #include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include <omp.h>
+
+#include "trie/AffixIndex.hpp"
+#include "trie/IndexHandle.hpp"
+#include "trie/PopularityRanking.hpp"
 #include "trie/Trie.hpp"
+#include "trie/TrieFile.hpp"
+#include "trie/TriePatch.hpp"
+#include "trie/WordPrefixIndex.hpp"
 
 class Timer {
   public:
@@ -38,9 +57,26 @@ class Timer {
     std::chrono::steady_clock::time_point m_begin;
 };
 
+void printMemoryUsage(const trie::MemoryUsage& memoryUsage) {
+  constexpr double numberOfBytesPerMibibyte = 1024.0 * 1024.0;
+  const auto printMemory = [numberOfBytesPerMibibyte](const std::string& label, size_t size) {
+        std::cout << label << static_cast<double>(size) / numberOfBytesPerMibibyte
+            << " MiB" << std::endl;
+      };
+
+  printMemory("Memory usage: ", memoryUsage.getTotal());
+  printMemory("  Node headers: ", memoryUsage.nodeHeaders);
+  printMemory("  Child arrays: ", memoryUsage.childArrays);
+  printMemory("  Slack: ", memoryUsage.slack);
+  printMemory("  Payloads: ", memoryUsage.payloads);
+  printMemory("  Allocator overhead: ", memoryUsage.allocatorOverhead);
+  std::cout << "Number of nodes: " << memoryUsage.numberOfNodes << std::endl;
+}
+
+template <typename TrieType>
 void testSearchPrefix(
       const std::vector<std::string>& strings,
-      const trie::Trie& trie,
+      const TrieType& trie,
       const std::string& prefix,
       bool printMatches = false) {
   Timer timer;
@@ -99,6 +135,341 @@ void testWithSimpleExample() {
   std::cout << std::endl;
   trie::Trie trie{strings};
   testSearchPrefix(strings, trie, "ha", true);
+
+  std::cout << std::endl;
+  std::cout << "Freezing trie..." << std::endl;
+  const trie::FrozenTrie frozenTrie{trie.freeze()};
+  testSearchPrefix(strings, frozenTrie, "h", true);
+
+  std::cout << std::endl;
+  std::cout << "Next characters after \"h\":" << std::endl;
+
+  for (const trie::FrozenTrie::NextCharacter& nextCharacter : frozenTrie.getNextCharacters("h")) {
+    std::cout << "'" << nextCharacter.character << "': " << nextCharacter.count << std::endl;
+  }
+
+  const std::vector<std::pair<std::string, std::string>> extensions{
+      {"hal", "hallo"}, {"w", "w"}, {"wel", "welt"}, {"wet", "wetter"}, {"x", "x"}};
+
+  for (const std::pair<std::string, std::string>& extension : extensions) {
+    if (frozenTrie.getLongestUnambiguousExtension(extension.first) != extension.second) {
+      throw std::runtime_error("Wrong extension for prefix \"" + extension.first + "\".");
+    }
+  }
+
+  std::cout << "Extension of \"hal\": " << frozenTrie.getLongestUnambiguousExtension("hal")
+      << std::endl;
+
+  const std::vector<size_t> shortestFirstStringIndices{
+      frozenTrie.searchPrefixShortestFirst("h")};
+  std::cout << "Matches of \"h\", shortest first:" << std::endl;
+
+  for (const size_t& stringIndex : shortestFirstStringIndices) {
+    std::cout << strings[stringIndex] << std::endl;
+  }
+
+  if ((shortestFirstStringIndices != std::vector<size_t>{5U, 1U, 2U})
+        || (trie.searchPrefixShortestFirst("h", 1U) != std::vector<size_t>{5U})) {
+    throw std::runtime_error("Wrong order of shortest-first matches.");
+  }
+
+  std::cout << std::endl;
+  trie::Trie ownedTrie{std::vector<std::string>(strings)};
+
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+    if (ownedTrie.getString(stringIndex) != strings[stringIndex]) {
+      throw std::runtime_error("Stored string does not equal input string.");
+    }
+  }
+
+  // trie doesn't own its strings, and ownedTrie doesn't have a string with this index
+  for (const trie::Trie* stringTrie : {&trie, &ownedTrie}) {
+    bool invalidStringIndexRejected{false};
+
+    try {
+      stringTrie->getString(strings.size());
+    } catch (const std::out_of_range& exception) {
+      std::cout << "Invalid string index rejected: " << exception.what() << std::endl;
+      invalidStringIndexRejected = true;
+    }
+
+    if (!invalidStringIndexRejected) {
+      throw std::runtime_error("Invalid string index has not been rejected.");
+    }
+  }
+
+  testSearchPrefix(strings, ownedTrie, "we", true);
+
+  std::cout << std::endl;
+  std::cout << "Clearing trie in background..." << std::endl;
+  std::future<void> clearFuture{ownedTrie.clearInBackground()};
+
+  if (!ownedTrie.searchPrefix("").empty() || !ownedTrie.getStrings().empty()) {
+    throw std::runtime_error("Trie is not empty after clearing in background.");
+  }
+
+  // the old nodes are destroyed by another thread, while the trie is refilled
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+    ownedTrie.insertString(strings, stringIndex);
+  }
+
+  clearFuture.get();
+  testSearchPrefix(strings, ownedTrie, "we", true);
+}
+
+void testIndexHandle() {
+  std::cout << std::endl;
+
+  const std::vector<std::string> oldStrings{"wetter", "hallo", "hello", "welt", "world", "haus"};
+  const std::vector<std::string> newStrings{"hafen", "hallo", "hase", "welt"};
+
+  trie::TrieHandle indexHandle{std::make_unique<trie::Trie>(oldStrings)};
+  const std::shared_ptr<const trie::Trie> oldTrie{indexHandle.acquire()};
+
+  std::cout << "Publishing new generation while a query holds the old one..." << std::endl;
+  indexHandle.publish(std::make_unique<trie::Trie>(newStrings));
+  std::cout << "Current generation: " << indexHandle.getGeneration() << std::endl;
+  std::cout << std::endl;
+
+  // the in-flight query still sees the old generation
+  testSearchPrefix(oldStrings, *oldTrie, "ha");
+  std::cout << std::endl;
+  testSearchPrefix(newStrings, *indexHandle.acquire(), "ha");
+
+  std::cout << std::endl;
+  std::cout << "Publishing new frozen generation while a query holds the old one..." << std::endl;
+  trie::FrozenTrieHandle frozenIndexHandle{
+      std::make_unique<trie::FrozenTrie>(trie::Trie{oldStrings}.freeze())};
+  const trie::FrozenTrieHandle::Snapshot oldSnapshot{frozenIndexHandle.acquireSnapshot()};
+  frozenIndexHandle.publish(std::make_unique<trie::FrozenTrie>(trie::Trie{newStrings}.freeze()));
+  const trie::FrozenTrieHandle::Snapshot newSnapshot{frozenIndexHandle.acquireSnapshot()};
+
+  if ((oldSnapshot.generation != 1U) || (newSnapshot.generation != 2U)) {
+    throw std::runtime_error("Wrong generation of frozen trie snapshot.");
+  }
+
+  testSearchPrefix(oldStrings, *oldSnapshot.index, "ha");
+  std::cout << std::endl;
+  testSearchPrefix(newStrings, *newSnapshot.index, "ha");
+}
+
+// returns whether load throws because the file to be loaded is corrupt
+bool isCorruptFileRejected(const std::function<void(void)>& load) {
+  try {
+    load();
+  } catch (const std::runtime_error& exception) {
+    std::cout << "Corrupt file rejected: " << exception.what() << std::endl;
+    return true;
+  }
+
+  return false;
+}
+
+// writes a copy of a frozen trie file, in which one 32-bit field of the record of a node is
+// replaced (or, if nodeIndex is numberOfNodeRecords, one byte is appended to the records);
+// the checksums are recomputed, so that only the consistency checks can detect the change
+void writeModifiedFrozenTrieFile(
+      const std::string& path,
+      const std::string& modifiedPath,
+      size_t numberOfNodeRecords,
+      size_t nodeIndex,
+      size_t fieldOffset,
+      std::uint32_t value) {
+  trie::TrieFile file{path, trie::TrieFile::FileType::frozenTrie};
+  std::vector<std::string> sections{file.readAllSections()};
+  std::vector<trie::TrieFile::SectionType> sectionTypes;
+
+  for (size_t sectionIndex = 0U; sectionIndex < sections.size(); sectionIndex++) {
+    sectionTypes.push_back(file.getSectionType(sectionIndex));
+    std::string& section{sections[sectionIndex]};
+
+    if (sectionTypes.back() != trie::TrieFile::SectionType::frozenNodes) {
+      continue;
+    }
+
+    if (nodeIndex == numberOfNodeRecords) {
+      section.push_back('\0');
+    } else {
+      std::string field;
+      trie::TrieFile::appendFixed(value, sizeof(value), field);
+      section.replace(nodeIndex * (section.size() / numberOfNodeRecords) + fieldOffset,
+          field.size(), field);
+    }
+  }
+
+  trie::TrieFile::write(modifiedPath, trie::TrieFile::FileType::frozenTrie, sectionTypes,
+      sections);
+}
+
+void testSerialization() {
+  std::cout << std::endl;
+
+  std::vector<std::string> strings{"wetter", "hallo", "hello", "welt", "world", "haus"};
+  const std::string triePath{"prefix_searcher_test.trie"};
+  const std::string frozenTriePath{"prefix_searcher_test.frozen"};
+  const std::string patchPath{"prefix_searcher_test.patch"};
+
+  trie::Trie{std::vector<std::string>(strings)}.save(triePath);
+  trie::Trie{strings}.freeze().save(frozenTriePath);
+
+  trie::TriePatch patch{strings.size()};
+  patch.deleteString("hallo");
+  patch.insertString("hase");
+  patch.save(patchPath);
+
+  std::cout << "Loading trie with patch (deleted \"hallo\", inserted \"hase\")..." << std::endl;
+  const trie::Trie trie{trie::Trie::load(triePath, {patchPath})};
+  // deleted strings keep their index, but don't match anything
+  strings[1U].clear();
+  strings.emplace_back("hase");
+
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+    if (!strings[stringIndex].empty() && (trie.getString(stringIndex) != strings[stringIndex])) {
+      throw std::runtime_error("Loaded string does not equal saved string.");
+    }
+  }
+
+  std::cout << std::endl;
+  testSearchPrefix(strings, trie, "ha", true);
+
+  std::cout << std::endl;
+  std::cout << "Loading frozen trie with patch..." << std::endl;
+  const trie::FrozenTrie frozenTrie{trie::FrozenTrie::load(frozenTriePath,
+      trie::FrozenTrie::DEFAULT_ROOT_TABLE_DEPTH, {patchPath})};
+  testSearchPrefix(strings, frozenTrie, "ha", true);
+
+  // a patch that doesn't continue the strings of the trie is rejected before "a" is deleted
+  trie::Trie ownedTrie{std::vector<std::string>{"a", "b"}};
+  trie::TriePatch misplacedPatch{1U};
+  misplacedPatch.deleteString("a");
+  misplacedPatch.insertString("c");
+  bool misplacedPatchRejected{false};
+
+  try {
+    ownedTrie.applyPatch(misplacedPatch);
+  } catch (const std::runtime_error& exception) {
+    std::cout << "Invalid patch rejected: " << exception.what() << std::endl;
+    misplacedPatchRejected = true;
+  }
+
+  // tries that don't own their strings reject patches that reuse the index of "b"
+  const std::vector<std::string> referencedStrings{"a", "b"};
+  trie::Trie referencingTrie{referencedStrings};
+
+  try {
+    referencingTrie.applyPatch(misplacedPatch);
+    misplacedPatchRejected = false;
+  } catch (const std::runtime_error& exception) {
+    std::cout << "Invalid patch rejected: " << exception.what() << std::endl;
+  }
+
+  if (!misplacedPatchRejected || ownedTrie.searchPrefix("a").empty()
+        || referencingTrie.searchPrefix("a").empty()) {
+    throw std::runtime_error("Invalid patch has not been rejected without changing the trie.");
+  }
+
+  // the nodes of the frozen trie of "a" and "b" are the root node, "a", "b", and the sentinel;
+  // each record starts with childBegin, terminalBegin, and subtreeEnd
+  const std::string modifiedFrozenTriePath{"prefix_searcher_test_modified.frozen"};
+  constexpr size_t numberOfNodeRecords = 4U;
+  constexpr size_t terminalBeginOffset = 4U;
+  constexpr size_t subtreeEndOffset = 8U;
+  trie::Trie{std::vector<std::string>{"a", "b"}}.freeze().save(frozenTriePath);
+  bool inconsistencyDetected{true};
+
+  // decreasing terminalBegin, empty subtree of "a", subtree of "a" exceeding its parent,
+  // incomplete record
+  for (const std::array<size_t, 3U>& modification : std::vector<std::array<size_t, 3U>>{
+        {1U, terminalBeginOffset, 2U}, {1U, subtreeEndOffset, 1U},
+        {1U, subtreeEndOffset, numberOfNodeRecords}, {numberOfNodeRecords, 0U, 0U}}) {
+    writeModifiedFrozenTrieFile(frozenTriePath, modifiedFrozenTriePath, numberOfNodeRecords,
+        modification[0U], modification[1U], static_cast<std::uint32_t>(modification[2U]));
+    inconsistencyDetected = inconsistencyDetected
+        && isCorruptFileRejected([&modifiedFrozenTriePath]() {
+              trie::FrozenTrie::load(modifiedFrozenTriePath);
+            });
+  }
+
+  std::remove(frozenTriePath.c_str());
+  std::remove(modifiedFrozenTriePath.c_str());
+
+  if (!inconsistencyDetected) {
+    throw std::runtime_error("Inconsistent frozen trie file has not been detected.");
+  }
+
+  // corrupt the last byte of the trie file, which belongs to the strings section
+  {
+    std::fstream stream{triePath, std::ios::binary | std::ios::in | std::ios::out};
+    stream.seekp(-1, std::ios::end);
+    stream.put('X');
+  }
+
+  const bool corruptionDetected{isCorruptFileRejected([&triePath]() {
+        trie::Trie::load(triePath);
+      })};
+
+  // truncate the trie file, so that the last section exceeds the end of the file (the header
+  // is still valid)
+  {
+    std::ifstream inputStream{triePath, std::ios::binary};
+    std::string bytes{std::istreambuf_iterator<char>{inputStream},
+        std::istreambuf_iterator<char>{}};
+    inputStream.close();
+    bytes.pop_back();
+    std::ofstream{triePath, std::ios::binary | std::ios::trunc}.write(
+        bytes.data(), static_cast<std::streamsize>(bytes.size()));
+  }
+
+  const bool truncationDetected{isCorruptFileRejected([&triePath]() {
+        trie::Trie::load(triePath);
+      })};
+
+  // append a byte to each section of the patch file (with valid checksums)
+  {
+    trie::TrieFile file{patchPath, trie::TrieFile::FileType::patch};
+    std::vector<std::string> sections{file.readAllSections()};
+    std::vector<trie::TrieFile::SectionType> sectionTypes;
+
+    for (size_t sectionIndex = 0U; sectionIndex < sections.size(); sectionIndex++) {
+      sectionTypes.push_back(file.getSectionType(sectionIndex));
+      sections[sectionIndex].push_back('\0');
+    }
+
+    trie::TrieFile::write(patchPath, trie::TrieFile::FileType::patch, sectionTypes, sections);
+  }
+
+  const bool trailingDataDetected{isCorruptFileRejected([&patchPath]() {
+        trie::TriePatch::load(patchPath);
+      })};
+
+  std::remove(triePath.c_str());
+  std::remove(patchPath.c_str());
+
+  if (!corruptionDetected || !truncationDetected || !trailingDataDetected) {
+    throw std::runtime_error("Corrupt trie file has not been detected.");
+  }
+
+  // string sections whose number of strings or lengths exceed the section (the lengths of the
+  // second section add up to 1 modulo 2^64)
+  std::string manyStrings;
+  trie::TrieFile::appendVarint(std::numeric_limits<std::uint64_t>::max(), manyStrings);
+  std::string overflowingLengths;
+  trie::TrieFile::appendVarint(2U, overflowingLengths);
+  trie::TrieFile::appendVarint(std::numeric_limits<std::uint64_t>::max(), overflowingLengths);
+  trie::TrieFile::appendVarint(2U, overflowingLengths);
+  overflowingLengths += "ab";
+  bool invalidStringsDetected{true};
+
+  for (const std::string& bytes : {manyStrings, overflowingLengths}) {
+    invalidStringsDetected = invalidStringsDetected && isCorruptFileRejected([&bytes]() {
+          size_t position{0U};
+          trie::TrieFile::decodeStrings(bytes, position);
+        });
+  }
+
+  if (!invalidStringsDetected) {
+    throw std::runtime_error("Invalid strings section has not been detected.");
+  }
 }
 
 std::string generateRandomString(size_t length, std::function<char(void)> getRandomCharacter) {
@@ -132,6 +503,424 @@ std::vector<std::string> generateRandomStrings(
   return std::vector<std::string>(std::begin(stringSet), std::end(stringSet));
 }
 
+void testDescents(
+      const std::vector<std::string>& strings,
+      const trie::Trie& trie,
+      const trie::FrozenTrie& frozenTrie) {
+  // descend with prefixes of random strings, of which some are altered to not exist
+  constexpr size_t numberOfPrefixes = 1000000U;
+  constexpr size_t maximumPrefixLength = 6U;
+  const unsigned int seed{42U};
+  std::default_random_engine randomNumberGenerator{seed};
+  std::uniform_int_distribution<size_t> stringIndexDistribution{0U, strings.size() - 1U};
+  std::uniform_int_distribution<size_t> prefixLengthDistribution{1U, maximumPrefixLength};
+  std::vector<std::string> prefixes;
+
+  for (size_t i = 0U; i < numberOfPrefixes; i++) {
+    std::string prefix{strings[stringIndexDistribution(randomNumberGenerator)].substr(
+        0U, prefixLengthDistribution(randomNumberGenerator))};
+
+    if (i % 2U == 1U) {
+      prefix.back() = '_';
+    }
+
+    prefixes.push_back(prefix);
+  }
+
+  Timer timer;
+  size_t numberOfFoundPrefixes{0U};
+  timer.start("Descending " + std::to_string(numberOfPrefixes) + " random prefixes via trie...");
+
+  for (const std::string& prefix : prefixes) {
+    numberOfFoundPrefixes += static_cast<size_t>(
+        trie.getRootNode().getDescendantNodeForPrefix(prefix) != nullptr);
+  }
+
+  timer.stop();
+  size_t numberOfFrozenFoundPrefixes{0U};
+  timer.start("Descending " + std::to_string(numberOfPrefixes)
+      + " random prefixes via frozen trie...");
+
+  for (const std::string& prefix : prefixes) {
+    numberOfFrozenFoundPrefixes += static_cast<size_t>(
+        frozenTrie.getDescendantNodeIndexForPrefix(prefix) != trie::FrozenTrie::INVALID_NODE_INDEX);
+  }
+
+  timer.stop();
+
+  if (numberOfFoundPrefixes == numberOfFrozenFoundPrefixes) {
+    std::cout << "Found " << numberOfFoundPrefixes << " prefixes in both tries." << std::endl;
+  } else {
+    throw std::runtime_error("Numbers of found prefixes in trie and frozen trie differ.");
+  }
+}
+
+void testCountPrefixes(
+      const std::vector<std::string>& strings,
+      const trie::Trie& trie,
+      const trie::FrozenTrie& frozenTrie) {
+  // sibling prefixes like a faceting UI would request them, plus some with other beginnings
+  const std::string characters{"0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz"};
+  constexpr size_t numberOfSiblingPrefixes = 50U;
+  std::vector<std::string> prefixes{"", "ab", "abc_", "zz", "a", "ab"};
+
+  for (size_t i = 0U; i < numberOfSiblingPrefixes; i++) {
+    prefixes.push_back("ab" + characters.substr(i, 1U));
+  }
+
+  Timer timer;
+  timer.start("Counting " + std::to_string(prefixes.size()) + " prefixes via trie...");
+  const std::vector<size_t> counts{trie.countPrefixes(prefixes)};
+  timer.stop();
+
+  timer.start("Counting " + std::to_string(prefixes.size()) + " prefixes via frozen trie...");
+  const std::vector<size_t> frozenCounts{frozenTrie.countPrefixes(prefixes)};
+  timer.stop();
+
+  for (size_t prefixIndex = 0U; prefixIndex < prefixes.size(); prefixIndex++) {
+    const std::string& prefix{prefixes[prefixIndex]};
+    const size_t expectedCount{static_cast<size_t>(std::count_if(
+        std::begin(strings), std::end(strings), [&prefix](const std::string& string) {
+          return string.compare(0U, prefix.length(), prefix) == 0;
+        }))};
+
+    if ((counts[prefixIndex] != expectedCount) || (frozenCounts[prefixIndex] != expectedCount)) {
+      throw std::runtime_error("Wrong count for prefix \"" + prefix + "\".");
+    }
+  }
+
+  std::cout << "Counted " << counts[1U] << " strings for prefix \"ab\"." << std::endl;
+}
+
+void testSearchPrefixesSorted(
+      const std::vector<std::string>& strings,
+      const trie::Trie& trie,
+      const trie::FrozenTrie& frozenTrie) {
+  // heavily overlapping prefixes (prefixes of random strings)
+  constexpr size_t numberOfPrefixes = 10000U;
+  constexpr size_t minimumPrefixLength = 2U;
+  constexpr size_t maximumPrefixLength = 4U;
+  const unsigned int seed{42U};
+  std::default_random_engine randomNumberGenerator{seed};
+  std::uniform_int_distribution<size_t> stringIndexDistribution{0U, strings.size() - 1U};
+  std::uniform_int_distribution<size_t> prefixLengthDistribution{
+      minimumPrefixLength, maximumPrefixLength};
+  std::vector<std::string> prefixes;
+
+  for (size_t i = 0U; i < numberOfPrefixes; i++) {
+    prefixes.push_back(strings[stringIndexDistribution(randomNumberGenerator)].substr(
+        0U, prefixLengthDistribution(randomNumberGenerator)));
+  }
+
+  Timer timer;
+  timer.start("Searching " + std::to_string(numberOfPrefixes)
+      + " prefixes one by one via frozen trie...");
+  std::vector<std::vector<size_t>> expectedResults;
+
+  for (const std::string& prefix : prefixes) {
+    expectedResults.push_back(frozenTrie.searchPrefix(prefix));
+  }
+
+  timer.stop();
+  timer.start("Searching " + std::to_string(numberOfPrefixes)
+      + " prefixes at once via frozen trie...");
+  const trie::PrefixSearchResults frozenResults{frozenTrie.searchPrefixesSorted(prefixes)};
+  timer.stop();
+  timer.start("Searching " + std::to_string(numberOfPrefixes) + " prefixes at once via trie...");
+  const trie::PrefixSearchResults results{trie.searchPrefixesSorted(prefixes)};
+  timer.stop();
+
+  for (size_t prefixIndex = 0U; prefixIndex < numberOfPrefixes; prefixIndex++) {
+    std::vector<size_t> matches{results.getMatches(prefixIndex)};
+    std::sort(std::begin(matches), std::end(matches));
+    std::vector<size_t>& expectedMatches{expectedResults[prefixIndex]};
+    std::sort(std::begin(expectedMatches), std::end(expectedMatches));
+
+    if ((frozenResults.getMatches(prefixIndex) != expectedResults[prefixIndex])
+          || (matches != expectedMatches)) {
+      throw std::runtime_error("Wrong matches for prefix \"" + prefixes[prefixIndex] + "\".");
+    }
+  }
+
+  std::cout << "Found " << results.stringIndices.size() << " matches in total." << std::endl;
+}
+
+void testFilteredSearchPrefix(
+      const std::vector<std::string>& strings,
+      const trie::FrozenTrie& frozenTrie,
+      const std::string& prefix) {
+  // a bitmap filter containing every seventh string, and a sorted filter containing a
+  // contiguous range of string indices, starting at one of the matches
+  constexpr size_t bitmapStep = 7U;
+  constexpr size_t numberOfSortedStringIndices = 5000U;
+  const std::vector<size_t> matches{frozenTrie.searchPrefix(prefix)};
+  const size_t firstSortedStringIndex{matches.empty() ? 0U : matches[matches.size() / 2U]};
+  std::vector<bool> bitmap(strings.size(), false);
+
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex += bitmapStep) {
+    bitmap[stringIndex] = true;
+  }
+
+  std::vector<size_t> sortedStringIndices(numberOfSortedStringIndices);
+  std::iota(std::begin(sortedStringIndices), std::end(sortedStringIndices),
+      firstSortedStringIndex);
+  const std::vector<std::pair<std::string, trie::StringIndexFilter>> filters{
+      {"bitmap", trie::StringIndexFilter{bitmap}},
+      {"sorted", trie::StringIndexFilter{sortedStringIndices}}};
+  Timer timer;
+
+  for (const std::pair<std::string, trie::StringIndexFilter>& filter : filters) {
+    timer.start("Searching prefix \"" + prefix + "\" and filtering afterwards with "
+        + filter.first + " filter via frozen trie...");
+    std::vector<size_t> expectedStringIndices{frozenTrie.searchPrefix(prefix)};
+    expectedStringIndices.erase(std::remove_if(std::begin(expectedStringIndices),
+          std::end(expectedStringIndices), [&filter](size_t stringIndex) {
+            return !filter.second.contains(stringIndex);
+          }), std::end(expectedStringIndices));
+    timer.stop();
+
+    timer.start("Searching prefix \"" + prefix + "\" with " + filter.first
+        + " filter via frozen trie...");
+    const std::vector<size_t> stringIndices{frozenTrie.searchPrefix(prefix, filter.second)};
+    timer.stop();
+
+    if (stringIndices != expectedStringIndices) {
+      throw std::runtime_error("Filtered search returned wrong matches.");
+    }
+
+    std::cout << "Found " << stringIndices.size() << " matches." << std::endl;
+  }
+}
+
+void testDictionaryEncoding(
+      const std::vector<std::string>& strings,
+      const trie::FrozenTrie& frozenTrie) {
+  // the random strings are sorted, so the ID of each string is its index
+  constexpr size_t stringIndexStep = 97U;
+  Timer timer;
+  timer.start("Encoding and decoding every " + std::to_string(stringIndexStep)
+      + "th string...");
+
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex += stringIndexStep) {
+    const size_t id{frozenTrie.encode(strings[stringIndex])};
+
+    if ((id != stringIndex) || (frozenTrie.getStringIndexForId(id) != stringIndex)
+          || (frozenTrie.decode(id) != strings[stringIndex])) {
+      throw std::runtime_error("Wrong dictionary encoding for \"" + strings[stringIndex] + "\".");
+    }
+  }
+
+  timer.stop();
+
+  if (frozenTrie.encode("abc_") != trie::FrozenTrie::INVALID_ID) {
+    throw std::runtime_error("Encoded string that is not in the frozen trie.");
+  }
+
+  const std::string prefix{"ab"};
+  const std::pair<size_t, size_t> idRange{frozenTrie.getIdRangeForPrefix(prefix)};
+  const auto lowerBound = std::lower_bound(std::begin(strings), std::end(strings), prefix);
+  const size_t expectedLowerId{static_cast<size_t>(lowerBound - std::begin(strings))};
+  const size_t expectedUpperId{expectedLowerId + frozenTrie.searchPrefix(prefix).size()};
+
+  if ((idRange.first != expectedLowerId) || (idRange.second != expectedUpperId)) {
+    throw std::runtime_error("Wrong ID range for prefix \"" + prefix + "\".");
+  }
+
+  std::cout << "IDs of strings with prefix \"" << prefix << "\": [" << idRange.first << ", "
+      << idRange.second << ")" << std::endl;
+}
+
+void testRankAndSelect(
+      const std::vector<std::string>& strings,
+      const trie::FrozenTrie& frozenTrie) {
+  // "pagination jumps": select the first string of some pages, and compute the rank of strings
+  // that are not in the trie
+  constexpr size_t pageSize = 50U;
+  constexpr size_t pageStep = 997U;
+  Timer timer;
+  timer.start("Selecting the first string of every " + std::to_string(pageStep) + "th page...");
+
+  for (size_t rank = 0U; rank < strings.size(); rank += pageSize * pageStep) {
+    if ((frozenTrie.select(rank) != strings[rank]) || (frozenTrie.rank(strings[rank]) != rank)) {
+      throw std::runtime_error("Wrong rank or select for rank " + std::to_string(rank) + ".");
+    }
+  }
+
+  timer.stop();
+
+  const std::vector<std::string> rankedStrings{"", "0", "ab", "abc_", "zzzzzzzzzzzz"};
+
+  for (const std::string& string : rankedStrings) {
+    const size_t expectedRank{static_cast<size_t>(std::lower_bound(
+        std::begin(strings), std::end(strings), string) - std::begin(strings))};
+
+    if (frozenTrie.rank(string) != expectedRank) {
+      throw std::runtime_error("Wrong rank for \"" + string + "\".");
+    }
+  }
+
+  std::cout << "Rank of \"abc_\": " << frozenTrie.rank("abc_") << std::endl;
+}
+
+void testSamplePrefix(
+      const std::vector<std::string>& strings,
+      const trie::FrozenTrie& frozenTrie,
+      const std::string& prefix) {
+  constexpr size_t numberOfSamples = 10U;
+  const unsigned int seed{42U};
+  std::default_random_engine randomNumberGenerator{seed};
+  Timer timer;
+  timer.start("Sampling " + std::to_string(numberOfSamples) + " strings for prefix \"" + prefix
+      + "\" via frozen trie...");
+  const std::vector<size_t> stringIndices{
+      frozenTrie.samplePrefix(prefix, numberOfSamples, randomNumberGenerator)};
+  timer.stop();
+
+  if ((stringIndices.size() != numberOfSamples)
+        || (std::adjacent_find(std::begin(stringIndices), std::end(stringIndices),
+          std::greater_equal<size_t>()) != std::end(stringIndices))) {
+    throw std::runtime_error("Samples are not distinct.");
+  }
+
+  for (const size_t& stringIndex : stringIndices) {
+    if (strings[stringIndex].compare(0U, prefix.length(), prefix) != 0) {
+      throw std::runtime_error("Sample \"" + strings[stringIndex] + "\" doesn't match.");
+    }
+
+    std::cout << strings[stringIndex] << std::endl;
+  }
+}
+
+void testEstimateCount(
+      const std::vector<std::string>& strings,
+      const trie::FrozenTrie& frozenTrie) {
+  // the last prefix is longer than the depth up to which counts are exact
+  constexpr size_t longPrefixLength = 6U;
+  const std::vector<std::string> prefixes{"", "a", "ab", "abc", "abcd", "abcd_",
+      strings[strings.size() / 2U].substr(0U, longPrefixLength)};
+  Timer timer;
+
+  for (const std::string& prefix : prefixes) {
+    timer.start("Estimating number of strings for prefix \"" + prefix + "\"...");
+    const trie::FrozenTrie::CountEstimate countEstimate{frozenTrie.estimateCount(prefix)};
+    timer.stop();
+    const size_t count{frozenTrie.searchPrefix(prefix).size()};
+    std::cout << "Estimated " << countEstimate.count << " (" << (countEstimate.isExact
+        ? "exact" : "approximate") << "), actual " << count << "." << std::endl;
+
+    if (countEstimate.isExact && (countEstimate.count != count)) {
+      throw std::runtime_error("Wrong exact estimate for prefix \"" + prefix + "\".");
+    }
+  }
+}
+
+void testNextCharacters(
+      const std::vector<std::string>& strings,
+      const trie::FrozenTrie& frozenTrie,
+      const std::string& prefix) {
+  Timer timer;
+  timer.start("Determining next characters after \"" + prefix + "\" via frozen trie...");
+  const std::vector<trie::FrozenTrie::NextCharacter> nextCharacters{
+      frozenTrie.getNextCharacters(prefix)};
+  timer.stop();
+
+  // derive the same from the matches
+  std::map<unsigned char, size_t> expectedCounts;
+
+  for (const size_t& stringIndex : frozenTrie.searchPrefix(prefix)) {
+    if (strings[stringIndex].length() > prefix.length()) {
+      expectedCounts[static_cast<unsigned char>(strings[stringIndex][prefix.length()])]++;
+    }
+  }
+
+  std::map<unsigned char, size_t> counts;
+
+  for (const trie::FrozenTrie::NextCharacter& nextCharacter : nextCharacters) {
+    counts[nextCharacter.character] = nextCharacter.count;
+  }
+
+  if (counts != expectedCounts) {
+    throw std::runtime_error("Wrong next characters after \"" + prefix + "\".");
+  }
+
+  std::cout << "Found " << nextCharacters.size() << " next characters." << std::endl;
+}
+
+void testSearchDeepestPrefix(
+      const std::vector<std::string>& strings,
+      const trie::Trie& trie,
+      const trie::FrozenTrie& frozenTrie) {
+  // "abc" is a path in the trie, but "abc_" is not
+  constexpr size_t maximumNumberOfMatches = 5U;
+  const std::string prefix{"abc_"};
+  Timer timer;
+  timer.start("Searching deepest prefix of \"" + prefix + "\" via trie...");
+  const trie::DeepestPrefixMatches matches{trie.searchDeepestPrefix(prefix)};
+  timer.stop();
+  timer.start("Searching deepest prefix of \"" + prefix + "\" via frozen trie...");
+  const trie::DeepestPrefixMatches frozenMatches{
+      frozenTrie.searchDeepestPrefix(prefix, maximumNumberOfMatches)};
+  timer.stop();
+
+  constexpr size_t expectedPrefixLength = 3U;
+  const std::string deepestPrefix{prefix.substr(0U, matches.prefixLength)};
+
+  if ((matches.prefixLength != expectedPrefixLength)
+        || (frozenMatches.prefixLength != expectedPrefixLength)) {
+    throw std::runtime_error("Wrong deepest prefix for \"" + prefix + "\".");
+  }
+
+  // the frozen trie returns the first matches in lexicographical order
+  std::vector<size_t> expectedStringIndices{frozenTrie.searchPrefix(deepestPrefix)};
+  std::vector<size_t> expectedFrozenStringIndices{expectedStringIndices};
+  expectedFrozenStringIndices.resize(
+      std::min(maximumNumberOfMatches, expectedFrozenStringIndices.size()));
+  std::vector<size_t> stringIndices{matches.stringIndices};
+  std::sort(std::begin(stringIndices), std::end(stringIndices));
+  std::sort(std::begin(expectedStringIndices), std::end(expectedStringIndices));
+
+  if ((stringIndices != expectedStringIndices)
+        || (frozenMatches.stringIndices != expectedFrozenStringIndices)) {
+    throw std::runtime_error("Wrong matches for deepest prefix of \"" + prefix + "\".");
+  }
+
+  std::cout << "Deepest prefix: \"" << deepestPrefix << "\" with "
+      << matches.stringIndices.size() << " matches:" << std::endl;
+
+  for (const size_t& stringIndex : frozenMatches.stringIndices) {
+    std::cout << strings[stringIndex] << std::endl;
+  }
+}
+
+void testSearchPrefixShortestFirst(
+      const std::vector<std::string>& strings,
+      const trie::FrozenTrie& frozenTrie,
+      const std::string& prefix) {
+  constexpr size_t maximumNumberOfMatches = 10U;
+  Timer timer;
+  timer.start("Searching " + std::to_string(maximumNumberOfMatches)
+      + " shortest matches of prefix \"" + prefix + "\" via frozen trie...");
+  const std::vector<size_t> stringIndices{
+      frozenTrie.searchPrefixShortestFirst(prefix, maximumNumberOfMatches)};
+  timer.stop();
+
+  // sort all matches by length (stable, so that ties stay in lexicographical order)
+  std::vector<size_t> expectedStringIndices{frozenTrie.searchPrefix(prefix)};
+  std::stable_sort(std::begin(expectedStringIndices), std::end(expectedStringIndices),
+      [&strings](size_t stringIndex1, size_t stringIndex2) {
+        return strings[stringIndex1].length() < strings[stringIndex2].length();
+      });
+  expectedStringIndices.resize(std::min(maximumNumberOfMatches, expectedStringIndices.size()));
+
+  if (stringIndices != expectedStringIndices) {
+    throw std::runtime_error("Wrong shortest matches for prefix \"" + prefix + "\".");
+  }
+
+  for (const size_t& stringIndex : stringIndices) {
+    std::cout << strings[stringIndex] << std::endl;
+  }
+}
+
 void testWithRandomStrings() {
   std::cout << std::endl;
   Timer timer;
@@ -149,10 +938,14 @@ void testWithRandomStrings() {
   trie::Trie trie{strings};
   timer.stop();
 
-  constexpr double numberOfBytesPerMibibyte = 1024.0 * 1024.0;
-  std::cout << "Memory usage: "
-      << static_cast<double>(trie.getRootNode().getSizeInMemory()) / numberOfBytesPerMibibyte
-      << " MiB" << std::endl;
+  printMemoryUsage(trie.getMemoryUsage(true));
+
+  std::cout << std::endl;
+  timer.start("Compacting trie...");
+  const size_t numberOfReclaimedBytes{trie.compact()};
+  timer.stop();
+  std::cout << "Reclaimed " << numberOfReclaimedBytes << " bytes." << std::endl;
+  printMemoryUsage(trie.getMemoryUsage(true));
 
   const std::string fullPrefix{"abcde"};
 
@@ -161,10 +954,403 @@ void testWithRandomStrings() {
     std::cout << std::endl;
     testSearchPrefix(strings, trie, prefix);
   }
+
+  std::cout << std::endl;
+  timer.start("Freezing trie...");
+  const trie::FrozenTrie frozenTrie{trie.freeze()};
+  timer.stop();
+  printMemoryUsage(frozenTrie.getMemoryUsage());
+  std::cout << std::endl;
+  testDescents(strings, trie, frozenTrie);
+  std::cout << std::endl;
+  testCountPrefixes(strings, trie, frozenTrie);
+  std::cout << std::endl;
+  testSearchPrefixesSorted(strings, trie, frozenTrie);
+  std::cout << std::endl;
+  testFilteredSearchPrefix(strings, frozenTrie, "a");
+  std::cout << std::endl;
+  testDictionaryEncoding(strings, frozenTrie);
+  std::cout << std::endl;
+  testRankAndSelect(strings, frozenTrie);
+  std::cout << std::endl;
+  testSamplePrefix(strings, frozenTrie, "a");
+  std::cout << std::endl;
+  testEstimateCount(strings, frozenTrie);
+  std::cout << std::endl;
+  testNextCharacters(strings, frozenTrie, "a");
+  std::cout << std::endl;
+  testSearchDeepestPrefix(strings, trie, frozenTrie);
+  std::cout << std::endl;
+  testSearchPrefixShortestFirst(strings, frozenTrie, "a");
+
+  for (size_t prefixLength = 1U; prefixLength <= fullPrefix.length(); prefixLength++) {
+    const std::string prefix{fullPrefix.substr(0U, prefixLength)};
+    std::cout << std::endl;
+    testSearchPrefix(strings, frozenTrie, prefix);
+  }
+
+  {
+    const std::string frozenTriePath{"prefix_searcher_benchmark.frozen"};
+    std::cout << std::endl;
+    timer.start("Saving frozen trie...");
+    frozenTrie.save(frozenTriePath);
+    timer.stop();
+
+    timer.start("Loading frozen trie...");
+    const trie::FrozenTrie loadedFrozenTrie{trie::FrozenTrie::load(frozenTriePath)};
+    timer.stop();
+
+    std::cout << std::endl;
+    testSearchPrefix(strings, loadedFrozenTrie, fullPrefix.substr(0U, 2U));
+
+    // compare with descents that don't use the root table
+    std::cout << std::endl;
+    timer.start("Loading frozen trie without root table...");
+    const trie::FrozenTrie loadedFrozenTrieWithoutRootTable{
+        trie::FrozenTrie::load(frozenTriePath, 0U)};
+    timer.stop();
+    std::remove(frozenTriePath.c_str());
+
+    testDescents(strings, trie, loadedFrozenTrieWithoutRootTable);
+  }
+
+  {
+    const std::string triePath{"prefix_searcher_benchmark.trie"};
+    std::cout << std::endl;
+    timer.start("Saving trie...");
+    trie.save(triePath);
+    timer.stop();
+
+    timer.start("Loading trie...");
+    const trie::Trie loadedTrie{trie::Trie::load(triePath)};
+    timer.stop();
+    std::remove(triePath.c_str());
+
+    std::cout << std::endl;
+    testSearchPrefix(strings, loadedTrie, fullPrefix.substr(0U, 2U));
+  }
+
+  std::cout << std::endl;
+  timer.start("Destroying trie...");
+  trie.clear();
+  timer.stop();
+
+  if (!trie.searchPrefix("").empty()) {
+    throw std::runtime_error("Trie is not empty after clearing.");
+  }
+}
+
+void testInsertBatch() {
+  std::cout << std::endl;
+  Timer timer;
+
+  constexpr size_t minimumStringLength = 1U;
+  constexpr size_t maximumStringLength = 20U;
+  constexpr size_t numberOfStrings = 400000U;
+  const std::vector<std::string> strings{generateRandomStrings(
+      minimumStringLength, maximumStringLength, numberOfStrings)};
+
+  // the initial trie contains every other string, the other strings are the delta
+  std::vector<size_t> initialStringIndices;
+  std::vector<size_t> deltaStringIndices;
+
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+    ((stringIndex % 2U == 0U) ? initialStringIndices : deltaStringIndices).push_back(stringIndex);
+  }
+
+  trie::Trie serialTrie{strings, initialStringIndices};
+  trie::Trie batchTrie{strings, initialStringIndices};
+
+  timer.start("Inserting " + std::to_string(deltaStringIndices.size())
+      + " strings one by one...");
+
+  for (const size_t& stringIndex : deltaStringIndices) {
+    serialTrie.insertString(strings, stringIndex);
+  }
+
+  timer.stop();
+  // use several threads even on machines with a single core, so that the parallel insertion is
+  // tested (including the creation of the nodes of the bucket prefixes)
+  const int maximumNumberOfThreads{omp_get_max_threads()};
+  constexpr int numberOfThreads = 4;
+  omp_set_num_threads(numberOfThreads);
+  timer.start("Inserting " + std::to_string(deltaStringIndices.size()) + " strings as batch...");
+  batchTrie.insertBatch(strings, deltaStringIndices);
+  timer.stop();
+  omp_set_num_threads(maximumNumberOfThreads);
+
+  for (const std::string& prefix : std::vector<std::string>{"", "a", "ab", "Z9"}) {
+    std::vector<size_t> serialStringIndices{serialTrie.searchPrefix(prefix)};
+    std::vector<size_t> batchStringIndices{batchTrie.searchPrefix(prefix)};
+    std::sort(std::begin(serialStringIndices), std::end(serialStringIndices));
+    std::sort(std::begin(batchStringIndices), std::end(batchStringIndices));
+
+    if (serialStringIndices != batchStringIndices) {
+      throw std::runtime_error("Batch insertion differs from serial insertion for prefix \""
+          + prefix + "\".");
+    }
+  }
+
+  if (batchTrie.searchPrefix("").size() != strings.size()) {
+    throw std::runtime_error("Batch insertion is missing strings.");
+  }
+}
+
+void testPopularityRanking() {
+  std::cout << std::endl;
+  Timer timer;
+
+  constexpr size_t minimumStringLength = 3U;
+  constexpr size_t maximumStringLength = 10U;
+  constexpr size_t numberOfStrings = 100000U;
+  const std::vector<std::string> strings{generateRandomStrings(
+      minimumStringLength, maximumStringLength, numberOfStrings)};
+  const trie::FrozenTrie frozenTrie{trie::Trie{strings}.freeze()};
+  trie::PopularityRanking popularityRanking{frozenTrie};
+
+  // simulate concurrent queries, each thread incrementing every string a few times
+  constexpr size_t numberOfThreads = 4U;
+  constexpr size_t numberOfDistinctCounts = 13U;
+  std::vector<std::thread> threads;
+  timer.start("Incrementing counters concurrently...");
+
+  for (size_t threadIndex = 0U; threadIndex < numberOfThreads; threadIndex++) {
+    threads.emplace_back([&popularityRanking]() {
+          for (size_t stringIndex = 0U; stringIndex < numberOfStrings; stringIndex++) {
+            popularityRanking.increment(stringIndex, stringIndex % numberOfDistinctCounts);
+          }
+        });
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  timer.stop();
+
+  const std::string prefix{"ab"};
+  constexpr size_t k = 10U;
+  constexpr double decayFactor = 0.5;
+
+  for (const double& currentDecayFactor : {1.0, decayFactor}) {
+    timer.start("Updating popularity ranking with decay factor "
+        + std::to_string(currentDecayFactor) + "...");
+    popularityRanking.update(currentDecayFactor);
+    timer.stop();
+
+    timer.start("Searching top " + std::to_string(k) + " strings for prefix \"" + prefix
+        + "\"...");
+    const std::vector<size_t> stringIndices{popularityRanking.topK(prefix, k)};
+    timer.stop();
+
+    // most popular strings first, ties in lexicographical order
+    std::vector<size_t> expectedStringIndices;
+
+    for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+      if (strings[stringIndex].compare(0U, prefix.length(), prefix) == 0) {
+        expectedStringIndices.push_back(stringIndex);
+      }
+    }
+
+    std::stable_sort(std::begin(expectedStringIndices), std::end(expectedStringIndices),
+        [&popularityRanking](size_t stringIndex1, size_t stringIndex2) {
+          return popularityRanking.getCount(stringIndex1)
+              > popularityRanking.getCount(stringIndex2);
+        });
+    expectedStringIndices.resize(std::min(k, expectedStringIndices.size()));
+
+    if (stringIndices != expectedStringIndices) {
+      throw std::runtime_error("Wrong top strings for prefix \"" + prefix + "\".");
+    }
+
+    for (const size_t& stringIndex : stringIndices) {
+      std::cout << strings[stringIndex] << " (" << popularityRanking.getCount(stringIndex)
+          << ")" << std::endl;
+    }
+  }
+
+  for (const double& invalidDecayFactor :
+        {-decayFactor, 1.0 + decayFactor, std::numeric_limits<double>::quiet_NaN()}) {
+    bool invalidDecayFactorRejected{false};
+
+    try {
+      popularityRanking.update(invalidDecayFactor);
+    } catch (const std::invalid_argument& exception) {
+      std::cout << "Invalid decay factor rejected: " << exception.what() << std::endl;
+      invalidDecayFactorRejected = true;
+    }
+
+    if (!invalidDecayFactorRejected) {
+      throw std::runtime_error("Invalid decay factor has not been rejected.");
+    }
+  }
+
+  std::cout << "Running periodic updates..." << std::endl;
+  constexpr std::chrono::milliseconds updateInterval{10};
+  popularityRanking.startPeriodicUpdates(updateInterval, decayFactor);
+  std::this_thread::sleep_for(updateInterval * 5);
+  popularityRanking.stopPeriodicUpdates();
+}
+
+void testAffixIndex() {
+  std::cout << std::endl;
+  Timer timer;
+
+  constexpr size_t minimumStringLength = 3U;
+  constexpr size_t maximumStringLength = 10U;
+  constexpr size_t numberOfStrings = 200000U;
+  const std::vector<std::string> strings{generateRandomStrings(
+      minimumStringLength, maximumStringLength, numberOfStrings)};
+
+  timer.start("Building affix index for " + std::to_string(strings.size()) + " strings...");
+  const trie::AffixIndex affixIndex{strings};
+  timer.stop();
+
+  const auto endsWith = [&strings](size_t stringIndex, const std::string& suffix) {
+        const std::string& string{strings[stringIndex]};
+        return (string.length() >= suffix.length())
+            && (string.compare(string.length() - suffix.length(), suffix.length(), suffix) == 0);
+      };
+
+  // duplicate strings are only stored once, so the expected matches are taken from the
+  // prefix search for the empty prefix
+  const std::vector<size_t> allStringIndices{affixIndex.searchPrefix("")};
+
+  for (const std::string& suffix : std::vector<std::string>{"", "a", "xy", "Q7z"}) {
+    std::vector<size_t> stringIndices{affixIndex.searchSuffix(suffix)};
+    std::sort(std::begin(stringIndices), std::end(stringIndices));
+    std::vector<size_t> expectedStringIndices;
+
+    for (const size_t& stringIndex : allStringIndices) {
+      if (endsWith(stringIndex, suffix)) {
+        expectedStringIndices.push_back(stringIndex);
+      }
+    }
+
+    std::sort(std::begin(expectedStringIndices), std::end(expectedStringIndices));
+
+    if (stringIndices != expectedStringIndices) {
+      throw std::runtime_error("Wrong matches for suffix \"" + suffix + "\".");
+    }
+  }
+
+  // both orders of the affix sizes, so that both sides of the intersection are used
+  for (const std::pair<std::string, std::string>& affixes :
+        std::vector<std::pair<std::string, std::string>>{
+          {"a", "bc"}, {"abc", "d"}, {"", "xy"}, {"xy", ""}, {"ab", "b"}, {"none", "none"}}) {
+    const std::string& prefix{affixes.first};
+    const std::string& suffix{affixes.second};
+    timer.start("Searching strings starting with \"" + prefix + "\" and ending with \""
+        + suffix + "\"...");
+    const std::vector<size_t> stringIndices{affixIndex.searchPrefixAndSuffix(prefix, suffix)};
+    timer.stop();
+
+    std::vector<size_t> expectedStringIndices;
+
+    for (const size_t& stringIndex : affixIndex.searchPrefix(prefix)) {
+      if (endsWith(stringIndex, suffix)) {
+        expectedStringIndices.push_back(stringIndex);
+      }
+    }
+
+    std::sort(std::begin(expectedStringIndices), std::end(expectedStringIndices));
+
+    if (stringIndices != expectedStringIndices) {
+      throw std::runtime_error("Wrong matches for prefix \"" + prefix + "\" and suffix \""
+          + suffix + "\".");
+    }
+
+    std::cout << stringIndices.size() << " matches" << std::endl;
+  }
+}
+
+void testWordPrefixIndex() {
+  std::cout << std::endl;
+  Timer timer;
+
+  const trie::WordPrefixIndex simpleWordPrefixIndex{
+      std::vector<std::string>{"new york city", "york", "new  new york", " ", "newark"}};
+
+  if ((simpleWordPrefixIndex.searchPrefix("yor") != std::vector<size_t>{0U, 1U, 2U})
+        || (simpleWordPrefixIndex.searchPrefix("new") != std::vector<size_t>{0U, 2U, 4U})
+        || (simpleWordPrefixIndex.searchPrefix("new y") != std::vector<size_t>{0U, 2U})
+        || (simpleWordPrefixIndex.searchPrefix("ork") != std::vector<size_t>{})
+        || (simpleWordPrefixIndex.searchPrefix("") != std::vector<size_t>{0U, 1U, 2U, 4U})) {
+    throw std::runtime_error("Wrong word prefix matches for simple example.");
+  }
+
+  // multi-word strings from a small vocabulary, so that words and suffixes repeat
+  constexpr size_t minimumWordLength = 2U;
+  constexpr size_t maximumWordLength = 5U;
+  constexpr size_t numberOfWords = 500U;
+  const std::vector<std::string> words{generateRandomStrings(
+      minimumWordLength, maximumWordLength, numberOfWords)};
+
+  constexpr size_t maximumNumberOfWordsPerString = 4U;
+  constexpr size_t numberOfStrings = 100000U;
+  const unsigned int seed{42U};
+  std::default_random_engine randomNumberGenerator{seed};
+  std::uniform_int_distribution<size_t> wordIndexDistribution{0U, words.size() - 1U};
+  std::uniform_int_distribution<size_t> numberOfWordsDistribution{
+      1U, maximumNumberOfWordsPerString};
+  std::vector<std::string> strings;
+
+  for (size_t stringIndex = 0U; stringIndex < numberOfStrings; stringIndex++) {
+    std::string string{words[wordIndexDistribution(randomNumberGenerator)]};
+
+    for (size_t wordIndex = numberOfWordsDistribution(randomNumberGenerator);
+          wordIndex-- > 1U;) {
+      string += " " + words[wordIndexDistribution(randomNumberGenerator)];
+    }
+
+    strings.push_back(string);
+  }
+
+  timer.start("Building word prefix index for " + std::to_string(strings.size())
+      + " multi-word strings...");
+  const trie::WordPrefixIndex wordPrefixIndex{strings};
+  timer.stop();
+  std::cout << wordPrefixIndex.getNumberOfSuffixes() << " word suffixes" << std::endl;
+
+  for (const std::string& prefix : std::vector<std::string>{
+        words[0U].substr(0U, 1U), words[1U], words[2U] + " ", "a", "zz", ""}) {
+    timer.start("Searching word prefix \"" + prefix + "\"...");
+    const std::vector<size_t> stringIndices{wordPrefixIndex.searchPrefix(prefix)};
+    timer.stop();
+
+    timer.start("Scanning all strings for word prefix \"" + prefix + "\"...");
+    std::vector<size_t> expectedStringIndices;
+
+    for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+      const std::string& string{strings[stringIndex]};
+
+      for (size_t characterIndex = 0U; characterIndex < string.length(); characterIndex++) {
+        if (((characterIndex == 0U) || (string[characterIndex - 1U] == ' '))
+              && (string.compare(characterIndex, prefix.length(), prefix) == 0)) {
+          expectedStringIndices.push_back(stringIndex);
+          break;
+        }
+      }
+    }
+
+    timer.stop();
+
+    if (stringIndices != expectedStringIndices) {
+      throw std::runtime_error("Wrong matches for word prefix \"" + prefix + "\".");
+    }
+
+    std::cout << stringIndices.size() << " matches" << std::endl;
+  }
 }
 
 int main() {
   testWithSimpleExample();
+  testIndexHandle();
+  testSerialization();
+  testInsertBatch();
+  testPopularityRanking();
+  testAffixIndex();
+  testWordPrefixIndex();
   testWithRandomStrings();
 
   return 0;
@@ -0,0 +1,118 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "trie/AffixIndex.hpp"
+#include "trie/FrozenTrie.hpp"
+#include "trie/Trie.hpp"
+
+namespace trie {
+
+AffixIndex::AffixIndex(const std::vector<std::string>& strings, size_t parallelPrefixLength) {
+  std::vector<std::string> reversedStrings;
+  reversedStrings.reserve(strings.size());
+  size_t numberOfCharacters{0U};
+
+  for (const std::string& string : strings) {
+    reversedStrings.emplace_back(string.rbegin(), string.rend());
+    numberOfCharacters += string.length();
+  }
+
+  std::vector<Trie> tries{Trie::createTries({&strings, &reversedStrings}, parallelPrefixLength)};
+  m_forwardTrie = tries[0U].freeze();
+  m_reversedTrie = tries[1U].freeze();
+
+  m_strings.reserve(strings.size(), numberOfCharacters);
+
+  for (const std::string& string : strings) {
+    m_strings.append(string);
+  }
+}
+
+size_t AffixIndex::getNumberOfStrings() const {
+  return m_strings.size();
+}
+
+std::vector<size_t> AffixIndex::searchPrefix(const std::string& prefix) const {
+  return m_forwardTrie.searchPrefix(prefix);
+}
+
+std::vector<size_t> AffixIndex::searchSuffix(const std::string& suffix) const {
+  return m_reversedTrie.searchPrefix(std::string(suffix.rbegin(), suffix.rend()));
+}
+
+std::vector<size_t> AffixIndex::searchPrefixAndSuffix(
+      const std::string& prefix,
+      const std::string& suffix) const {
+  const std::string reversedSuffix(suffix.rbegin(), suffix.rend());
+  const std::pair<size_t, size_t> prefixIdRange{m_forwardTrie.getIdRangeForPrefix(prefix)};
+  const std::pair<size_t, size_t> suffixIdRange{
+      m_reversedTrie.getIdRangeForPrefix(reversedSuffix)};
+  std::vector<size_t> stringIndices;
+
+  // enumerate the matches of the affix with fewer matches (the IDs of the matches are the
+  // contiguous ID range), and check the other affix on the strings themselves, which is
+  // cheaper than enumerating the matches of the other affix as well
+  if (prefixIdRange.second - prefixIdRange.first
+        <= suffixIdRange.second - suffixIdRange.first) {
+    for (size_t id = prefixIdRange.first; id < prefixIdRange.second; id++) {
+      const size_t stringIndex{m_forwardTrie.getStringIndexForId(id)};
+
+      if (hasSuffix(stringIndex, suffix)) {
+        stringIndices.push_back(stringIndex);
+      }
+    }
+  } else {
+    for (size_t id = suffixIdRange.first; id < suffixIdRange.second; id++) {
+      const size_t stringIndex{m_reversedTrie.getStringIndexForId(id)};
+
+      if (hasPrefix(stringIndex, prefix)) {
+        stringIndices.push_back(stringIndex);
+      }
+    }
+  }
+
+  std::sort(std::begin(stringIndices), std::end(stringIndices));
+  return stringIndices;
+}
+
+bool AffixIndex::hasPrefix(size_t stringIndex, const std::string& prefix) const {
+  if (m_strings.getLength(stringIndex) < prefix.length()) {
+    return false;
+  }
+
+  for (size_t characterIndex = 0U; characterIndex < prefix.length(); characterIndex++) {
+    if (m_strings.getCharacter(stringIndex, characterIndex) != prefix[characterIndex]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool AffixIndex::hasSuffix(size_t stringIndex, const std::string& suffix) const {
+  const size_t length{m_strings.getLength(stringIndex)};
+
+  if (length < suffix.length()) {
+    return false;
+  }
+
+  const size_t offset{length - suffix.length()};
+
+  for (size_t characterIndex = 0U; characterIndex < suffix.length(); characterIndex++) {
+    if (m_strings.getCharacter(stringIndex, offset + characterIndex) != suffix[characterIndex]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+}  // namespace trie
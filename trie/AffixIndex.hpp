@@ -0,0 +1,49 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_AFFIXINDEX_HPP
+#define TRIE_AFFIXINDEX_HPP
+
+#include <string>
+#include <vector>
+
+#include "trie/FrozenTrie.hpp"
+#include "trie/StringBuffer.hpp"
+
+namespace trie {
+
+// Index for prefix and suffix searches: a frozen trie of the strings and a frozen trie of the
+// reversed strings (in which a suffix search is a prefix search for the reversed suffix). Both
+// tries are built in the same parallel pass.
+class AffixIndex {
+  public:
+    explicit AffixIndex(
+        const std::vector<std::string>& strings,
+        size_t parallelPrefixLength = 2U);
+
+    size_t getNumberOfStrings() const;
+
+    std::vector<size_t> searchPrefix(const std::string& prefix) const;
+    std::vector<size_t> searchSuffix(const std::string& suffix) const;
+    // returns the string indices (in ascending order) of the strings that start with prefix and
+    // end with suffix (prefix and suffix may overlap)
+    std::vector<size_t> searchPrefixAndSuffix(
+        const std::string& prefix,
+        const std::string& suffix) const;
+
+  private:
+    bool hasPrefix(size_t stringIndex, const std::string& prefix) const;
+    bool hasSuffix(size_t stringIndex, const std::string& suffix) const;
+
+    FrozenTrie m_forwardTrie;
+    FrozenTrie m_reversedTrie;
+    StringBuffer m_strings;
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_AFFIXINDEX_HPP
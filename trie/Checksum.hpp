@@ -0,0 +1,96 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_CHECKSUM_HPP
+#define TRIE_CHECKSUM_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+namespace trie {
+
+class Checksum {
+  public:
+    // CRC-32 (polynomial 0xEDB88320, as used by zlib)
+    static std::uint32_t computeCrc32(const std::string& data) {
+      // slicing-by-8: eight bytes are processed per step with one table per byte position
+      static const Crc32Tables tables{createCrc32Tables()};
+      std::uint32_t crc{~std::uint32_t{0U}};
+      size_t position{0U};
+
+      for (; position + numberOfSlices <= data.size(); position += numberOfSlices) {
+        const std::uint32_t low{crc ^ readUint32(data, position)};
+        const std::uint32_t high{readUint32(data, position + numberOfSlices / 2U)};
+        crc = tables[7U][low & byteMask]
+            ^ tables[6U][(low >> numberOfBitsPerByte) & byteMask]
+            ^ tables[5U][(low >> (2U * numberOfBitsPerByte)) & byteMask]
+            ^ tables[4U][low >> (3U * numberOfBitsPerByte)]
+            ^ tables[3U][high & byteMask]
+            ^ tables[2U][(high >> numberOfBitsPerByte) & byteMask]
+            ^ tables[1U][(high >> (2U * numberOfBitsPerByte)) & byteMask]
+            ^ tables[0U][high >> (3U * numberOfBitsPerByte)];
+      }
+
+      for (; position < data.size(); position++) {
+        const std::uint32_t byte{static_cast<unsigned char>(data[position])};
+        crc = tables[0U][(crc ^ byte) & byteMask] ^ (crc >> numberOfBitsPerByte);
+      }
+
+      return ~crc;
+    }
+
+  private:
+    static constexpr size_t numberOfBytes = 256U;
+    static constexpr size_t numberOfSlices = 8U;
+    static constexpr std::uint32_t byteMask = 0xFFU;
+    static constexpr std::uint32_t numberOfBitsPerByte = 8U;
+    static constexpr std::uint32_t crc32Polynomial = 0xEDB88320U;
+
+    using Crc32Tables = std::array<std::array<std::uint32_t, numberOfBytes>, numberOfSlices>;
+
+    // little endian, independent of the byte order of the host
+    static std::uint32_t readUint32(const std::string& data, size_t position) {
+      std::uint32_t value{0U};
+
+      for (size_t i = 0U; i < sizeof(value); i++) {
+        value |= static_cast<std::uint32_t>(static_cast<unsigned char>(data[position + i]))
+            << (i * numberOfBitsPerByte);
+      }
+
+      return value;
+    }
+
+    static Crc32Tables createCrc32Tables() {
+      Crc32Tables tables{};
+
+      for (std::uint32_t byte = 0U; byte < numberOfBytes; byte++) {
+        std::uint32_t crc{byte};
+
+        for (std::uint32_t bit = 0U; bit < numberOfBitsPerByte; bit++) {
+          crc = ((crc & 1U) != 0U) ? ((crc >> 1U) ^ crc32Polynomial) : (crc >> 1U);
+        }
+
+        tables[0U][byte] = crc;
+      }
+
+      // tables[slice][byte] is the CRC of the byte followed by slice zero bytes
+      for (size_t slice = 1U; slice < numberOfSlices; slice++) {
+        for (size_t byte = 0U; byte < numberOfBytes; byte++) {
+          const std::uint32_t previousCrc{tables[slice - 1U][byte]};
+          tables[slice][byte] = tables[0U][previousCrc & byteMask]
+              ^ (previousCrc >> numberOfBitsPerByte);
+        }
+      }
+
+      return tables;
+    }
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_CHECKSUM_HPP
@@ -0,0 +1,1089 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "trie/FrozenTrie.hpp"
+#include "trie/MemoryUsage.hpp"
+#include "trie/Node.hpp"
+#include "trie/PrefixDescent.hpp"
+#include "trie/Trie.hpp"
+#include "trie/TrieFile.hpp"
+#include "trie/TriePatch.hpp"
+
+namespace trie {
+
+namespace {
+
+constexpr size_t maximumNumberOfChildNodes = 256U;
+// childBegin, terminalBegin, and subtreeEnd of a node in frozen trie files
+using FrozenNodeRecord = std::array<std::uint32_t, 3U>;
+constexpr size_t frozenNodeSize = 4U + 4U + 4U;
+
+constexpr size_t bitmapWordSize = 64U;
+
+constexpr size_t rootTableRadix = 256U;
+
+constexpr size_t numberOfBitsPerByte = 8U;
+
+constexpr std::uint32_t byteMask = 0xFFU;
+
+#ifdef __SSE2__
+// number of child keys compared at once
+constexpr size_t keyVectorSize = 16U;
+
+constexpr unsigned char signBit = 0x80U;
+#endif
+
+using ChildOrder = std::array<unsigned char, maximumNumberOfChildNodes>;
+
+// positions of the child nodes of node in m_keysAndChildNodes, sorted by key
+void getSortedChildOrder(const Node& node, ChildOrder& childOrder) {
+  const size_t numberOfChildNodes{node.getNumberOfChildNodes()};
+
+  for (size_t childIndex = 0U; childIndex < numberOfChildNodes; childIndex++) {
+    childOrder[childIndex] = static_cast<unsigned char>(childIndex);
+  }
+
+  std::sort(std::begin(childOrder),
+      std::begin(childOrder) + static_cast<std::ptrdiff_t>(numberOfChildNodes),
+      [&node](unsigned char childIndex1, unsigned char childIndex2) {
+        return node.getChildKeyAt(childIndex1) < node.getChildKeyAt(childIndex2);
+      });
+}
+
+// returns the number of nodes and the number of strings in the subtree of node
+std::pair<size_t, size_t> countSubtree(const Node& node) {
+  size_t numberOfNodes{0U};
+  size_t numberOfStrings{0U};
+  std::vector<const Node*> stack{&node};
+
+  while (!stack.empty()) {
+    const Node* currentNode{stack.back()};
+    stack.pop_back();
+    numberOfNodes++;
+
+    if (currentNode->getStringIndex() != Node::INVALID_STRING_INDEX) {
+      numberOfStrings++;
+    }
+
+    for (size_t childIndex = 0U; childIndex < currentNode->getNumberOfChildNodes();
+          childIndex++) {
+      stack.push_back(currentNode->getChildNodeAt(childIndex));
+    }
+  }
+
+  return {numberOfNodes, numberOfStrings};
+}
+
+// returns whether the sorted keys contain key and sets position to the number of keys
+// smaller than key (only valid if key is found)
+bool findSparseChildKey(
+      const unsigned char* keys,
+      size_t numberOfKeys,
+      unsigned char key,
+      size_t& position) {
+  position = 0U;
+
+  for (size_t i = 0U; i < numberOfKeys; i++) {
+    position += static_cast<size_t>(keys[i] < key);
+  }
+
+  position = std::min(position, numberOfKeys - 1U);
+  return (keys[position] == key);
+}
+
+#ifdef __SSE2__
+// same as findSparseChildKey, but compares key with all keys at once; keyVectorSize bytes must
+// be readable at keys
+bool findSparseChildKeyVectorized(
+      const unsigned char* keys,
+      size_t numberOfKeys,
+      unsigned char key,
+      size_t& position) {
+  // SSE2 only has signed byte comparisons, so the sign bits are flipped to compare unsigned
+  const __m128i signBits{_mm_set1_epi8(static_cast<char>(signBit))};
+  const __m128i keyVector{_mm_loadu_si128(reinterpret_cast<const __m128i*>(keys))};
+  const __m128i queryVector{_mm_set1_epi8(static_cast<char>(key))};
+  const __m128i lessMask{_mm_cmplt_epi8(_mm_xor_si128(keyVector, signBits),
+      _mm_xor_si128(queryVector, signBits))};
+  const __m128i equalMask{_mm_cmpeq_epi8(keyVector, queryVector)};
+  const unsigned int validBits{(1U << numberOfKeys) - 1U};
+
+  position = std::bitset<keyVectorSize>{
+      static_cast<unsigned int>(_mm_movemask_epi8(lessMask)) & validBits}.count();
+  return ((static_cast<unsigned int>(_mm_movemask_epi8(equalMask)) & validBits) != 0U);
+}
+#endif
+
+void checkConsistency(bool condition) {
+  if (!condition) {
+    throw std::runtime_error("Inconsistent frozen trie file.");
+  }
+}
+
+}  // namespace
+
+// definitions of the constants, which are required in C++14 if they are bound to references
+constexpr FrozenTrie::NodeIndex FrozenTrie::INVALID_NODE_INDEX;
+constexpr size_t FrozenTrie::INVALID_ID;
+constexpr size_t FrozenTrie::DEFAULT_ROOT_TABLE_DEPTH;
+constexpr size_t FrozenTrie::MAXIMUM_ROOT_TABLE_DEPTH;
+constexpr size_t FrozenTrie::MAXIMUM_NUMBER_OF_ESTIMATION_STEPS;
+
+FrozenTrie::FrozenTrie()
+      : m_nodes{{0U, 0U, 1U, INVALID_CHILD_LOOKUP}, {0U, 0U, 1U, INVALID_CHILD_LOOKUP}} {
+  createRootTable(0U);
+}
+
+FrozenTrie::FrozenTrie(const Node& rootNode, size_t rootTableDepth) {
+  // the subtrees of the children of the root node are frozen in parallel: first, they are
+  // counted to determine where each subtree is stored, then they are frozen into their ranges
+  const size_t numberOfRootChildNodes{rootNode.getNumberOfChildNodes()};
+  ChildOrder rootChildOrder{};
+  getSortedChildOrder(rootNode, rootChildOrder);
+
+  std::vector<std::pair<size_t, size_t>> subtreeCounts(numberOfRootChildNodes);
+
+  #pragma omp parallel for default(none) \
+      shared(rootNode, numberOfRootChildNodes, rootChildOrder, subtreeCounts) schedule(dynamic)
+  for (size_t i = 0U; i < numberOfRootChildNodes; i++) {
+    subtreeCounts[i] = countSubtree(*rootNode.getChildNodeAt(rootChildOrder[i]));
+  }
+
+  std::vector<size_t> nodeBegins(numberOfRootChildNodes);
+  std::vector<size_t> childBegins(numberOfRootChildNodes);
+  std::vector<size_t> terminalBegins(numberOfRootChildNodes);
+  size_t numberOfNodes{1U};
+  size_t numberOfStrings{(rootNode.getStringIndex() != Node::INVALID_STRING_INDEX) ? 1U : 0U};
+
+  for (size_t i = 0U; i < numberOfRootChildNodes; i++) {
+    nodeBegins[i] = numberOfNodes;
+    // the child entries of the root node are followed by the child entries of the subtrees
+    // (a subtree with n nodes has n - 1 child entries)
+    childBegins[i] = numberOfRootChildNodes + (numberOfNodes - 1U) - i;
+    terminalBegins[i] = numberOfStrings;
+    numberOfNodes += subtreeCounts[i].first;
+    numberOfStrings += subtreeCounts[i].second;
+  }
+
+  if ((numberOfNodes >= INVALID_NODE_INDEX)
+        || (numberOfStrings > std::numeric_limits<std::uint32_t>::max())) {
+    throw std::length_error("Trie is too large to be frozen.");
+  }
+
+  m_nodes.resize(numberOfNodes + 1U);
+  m_childKeys.resize(numberOfNodes - 1U);
+  m_childNodeIndices.resize(numberOfNodes - 1U);
+  m_stringIndices.resize(numberOfStrings);
+
+  m_nodes[0U] = {0U, 0U, static_cast<NodeIndex>(numberOfNodes), INVALID_CHILD_LOOKUP};
+
+  if (rootNode.getStringIndex() != Node::INVALID_STRING_INDEX) {
+    m_stringIndices[0U] = rootNode.getStringIndex();
+  }
+
+  for (size_t i = 0U; i < numberOfRootChildNodes; i++) {
+    m_childKeys[i] = rootNode.getChildKeyAt(rootChildOrder[i]);
+    m_childNodeIndices[i] = static_cast<NodeIndex>(nodeBegins[i]);
+  }
+
+  #pragma omp parallel for default(none) shared(rootNode, numberOfRootChildNodes, \
+      rootChildOrder, nodeBegins, childBegins, terminalBegins) schedule(dynamic)
+  for (size_t i = 0U; i < numberOfRootChildNodes; i++) {
+    freezeSubtree(*rootNode.getChildNodeAt(rootChildOrder[i]),
+        static_cast<NodeIndex>(nodeBegins[i]), static_cast<std::uint32_t>(childBegins[i]),
+        static_cast<std::uint32_t>(terminalBegins[i]));
+  }
+
+  // sentinel, so that the terminalBegin of the next node can always be accessed
+  m_nodes[numberOfNodes] = {static_cast<std::uint32_t>(numberOfNodes - 1U),
+      static_cast<std::uint32_t>(numberOfStrings), static_cast<NodeIndex>(numberOfNodes),
+      INVALID_CHILD_LOOKUP};
+
+  createChildLookups();
+  createRootTable(rootTableDepth);
+  createTerminalBlockRanges();
+}
+
+void FrozenTrie::freezeSubtree(
+      const Node& rootNode,
+      NodeIndex nodeIndex,
+      std::uint32_t childBegin,
+      std::uint32_t terminalBegin) {
+  struct Frame {
+    const Node* node;
+    NodeIndex nodeIndex;
+    std::uint32_t childBegin;
+    size_t nextChild;
+    ChildOrder childOrder;
+  };
+
+  NodeIndex nextNodeIndex{nodeIndex};
+  std::uint32_t nextChildBegin{childBegin};
+  std::uint32_t nextTerminal{terminalBegin};
+  std::vector<Frame> stack;
+
+  // store the node at the next preorder position and reserve its child entries
+  const auto visitNode = [this, &nextNodeIndex, &nextChildBegin, &nextTerminal, &stack](
+        const Node& node) {
+        const size_t numberOfChildNodes{node.getNumberOfChildNodes()};
+        stack.push_back({&node, nextNodeIndex, nextChildBegin, 0U, {}});
+        Frame& frame{stack.back()};
+        getSortedChildOrder(node, frame.childOrder);
+
+        m_nodes[nextNodeIndex] = {nextChildBegin, nextTerminal, 0U, INVALID_CHILD_LOOKUP};
+
+        if (node.getStringIndex() != Node::INVALID_STRING_INDEX) {
+          m_stringIndices[nextTerminal] = node.getStringIndex();
+          nextTerminal++;
+        }
+
+        for (size_t i = 0U; i < numberOfChildNodes; i++) {
+          m_childKeys[nextChildBegin + i] = node.getChildKeyAt(frame.childOrder[i]);
+        }
+
+        nextNodeIndex++;
+        nextChildBegin += static_cast<std::uint32_t>(numberOfChildNodes);
+      };
+
+  visitNode(rootNode);
+
+  while (!stack.empty()) {
+    Frame& frame{stack.back()};
+
+    if (frame.nextChild == frame.node->getNumberOfChildNodes()) {
+      m_nodes[frame.nodeIndex].subtreeEnd = nextNodeIndex;
+      stack.pop_back();
+      continue;
+    }
+
+    const size_t i{frame.nextChild};
+    frame.nextChild++;
+    m_childNodeIndices[frame.childBegin + i] = nextNodeIndex;
+    // frame is invalidated by visitNode
+    visitNode(*frame.node->getChildNodeAt(frame.childOrder[i]));
+  }
+}
+
+FrozenTrie::NodeIndex FrozenTrie::getNumberOfNodes() const {
+  return static_cast<NodeIndex>(m_nodes.size() - 1U);
+}
+
+size_t FrozenTrie::getNumberOfStrings() const {
+  return m_stringIndices.size();
+}
+
+MemoryUsage FrozenTrie::getMemoryUsage() const {
+  MemoryUsage memoryUsage;
+  memoryUsage.numberOfNodes = getNumberOfNodes();
+  memoryUsage.nodeHeaders = m_nodes.size() * sizeof(FrozenNode);
+  memoryUsage.childArrays = m_childKeys.size() * sizeof(unsigned char)
+      + m_childNodeIndices.size() * sizeof(NodeIndex)
+      + m_childBitmaps.size() * sizeof(ChildBitmap)
+      + m_rootTable.size() * sizeof(NodeIndex);
+
+  for (const std::vector<std::uint32_t>& prefixCountHistogram : m_prefixCountHistograms) {
+    memoryUsage.childArrays += prefixCountHistogram.size() * sizeof(std::uint32_t);
+  }
+
+  memoryUsage.payloads = m_stringIndices.size() * sizeof(size_t)
+      + m_terminalBlockRanges.size() * sizeof(StringIndexRange);
+  memoryUsage.slack = (m_nodes.capacity() - m_nodes.size()) * sizeof(FrozenNode)
+      + (m_childKeys.capacity() - m_childKeys.size()) * sizeof(unsigned char)
+      + (m_childNodeIndices.capacity() - m_childNodeIndices.size()) * sizeof(NodeIndex)
+      + (m_stringIndices.capacity() - m_stringIndices.size()) * sizeof(size_t);
+  memoryUsage.allocatorOverhead =
+      MemoryUsage::getAllocatorOverhead(m_nodes.data(),
+        m_nodes.capacity() * sizeof(FrozenNode), false)
+      + MemoryUsage::getAllocatorOverhead(m_childKeys.data(), m_childKeys.capacity(), false)
+      + MemoryUsage::getAllocatorOverhead(m_childNodeIndices.data(),
+        m_childNodeIndices.capacity() * sizeof(NodeIndex), false)
+      + MemoryUsage::getAllocatorOverhead(m_stringIndices.data(),
+        m_stringIndices.capacity() * sizeof(size_t), false);
+  return memoryUsage;
+}
+
+void FrozenTrie::createChildLookups() {
+  m_childBitmaps.clear();
+  const NodeIndex numberOfNodes{getNumberOfNodes()};
+
+  for (NodeIndex nodeIndex = 0U; nodeIndex < numberOfNodes; nodeIndex++) {
+    FrozenNode& node{m_nodes[nodeIndex]};
+    const size_t numberOfChildNodes{getNumberOfChildNodes(nodeIndex)};
+
+    if (numberOfChildNodes <= MAXIMUM_NUMBER_OF_INLINE_CHILD_KEYS) {
+      node.childLookup = 0U;
+
+      for (size_t i = 0U; i < numberOfChildNodes; i++) {
+        node.childLookup |= static_cast<std::uint32_t>(m_childKeys[node.childBegin + i])
+            << (i * numberOfBitsPerByte);
+      }
+    } else if (numberOfChildNodes >= MINIMUM_NUMBER_OF_CHILD_NODES_FOR_BITMAP) {
+      node.childLookup = static_cast<std::uint32_t>(m_childBitmaps.size());
+      m_childBitmaps.emplace_back();
+      ChildBitmap& childBitmap{m_childBitmaps.back()};
+
+      for (size_t i = 0U; i < numberOfChildNodes; i++) {
+        const unsigned char key{m_childKeys[node.childBegin + i]};
+        childBitmap[key / bitmapWordSize] |= std::uint64_t{1U} << (key % bitmapWordSize);
+      }
+    } else {
+      node.childLookup = INVALID_CHILD_LOOKUP;
+    }
+  }
+}
+
+void FrozenTrie::createRootTable(size_t rootTableDepth) {
+  if (rootTableDepth > MAXIMUM_ROOT_TABLE_DEPTH) {
+    throw std::invalid_argument("Root table depth " + std::to_string(rootTableDepth)
+        + " exceeds the maximum of " + std::to_string(MAXIMUM_ROOT_TABLE_DEPTH) + ".");
+  }
+
+  m_rootTableDepth = rootTableDepth;
+  m_rootTable.clear();
+  m_prefixCountHistograms.clear();
+  size_t histogramSize{1U};
+
+  // the histogram for prefixes of length depth has 256^depth entries
+  for (size_t depth = 0U; depth <= rootTableDepth; depth++) {
+    m_prefixCountHistograms.emplace_back(histogramSize, 0U);
+    histogramSize *= rootTableRadix;
+  }
+
+  if (rootTableDepth > 0U) {
+    m_rootTable.assign(m_prefixCountHistograms.back().size(), INVALID_NODE_INDEX);
+  }
+
+  // visit all nodes up to depth rootTableDepth, keeping track of the table index of the
+  // prefix of each node
+  struct Entry {
+    NodeIndex nodeIndex;
+    size_t depth;
+    size_t rootTableIndex;
+  };
+
+  std::vector<Entry> stack{{0U, 0U, 0U}};
+
+  while (!stack.empty()) {
+    const Entry entry{stack.back()};
+    stack.pop_back();
+    m_prefixCountHistograms[entry.depth][entry.rootTableIndex] =
+        static_cast<std::uint32_t>(getNumberOfStringsInSubtree(entry.nodeIndex));
+
+    if (entry.depth == rootTableDepth) {
+      if (rootTableDepth > 0U) {
+        m_rootTable[entry.rootTableIndex] = entry.nodeIndex;
+      }
+
+      continue;
+    }
+
+    const std::uint32_t childBegin{m_nodes[entry.nodeIndex].childBegin};
+
+    for (size_t i = 0U; i < getNumberOfChildNodes(entry.nodeIndex); i++) {
+      stack.push_back({m_childNodeIndices[childBegin + i], entry.depth + 1U,
+          entry.rootTableIndex * rootTableRadix + m_childKeys[childBegin + i]});
+    }
+  }
+}
+
+void FrozenTrie::createTerminalBlockRanges() {
+  const size_t numberOfBlocks{
+      (m_stringIndices.size() + TERMINAL_BLOCK_SIZE - 1U) / TERMINAL_BLOCK_SIZE};
+  m_terminalBlockRanges.resize(numberOfBlocks);
+
+  for (size_t blockIndex = 0U; blockIndex < numberOfBlocks; blockIndex++) {
+    const auto blockBegin = std::begin(m_stringIndices)
+        + static_cast<std::ptrdiff_t>(blockIndex * TERMINAL_BLOCK_SIZE);
+    const auto blockEnd = std::begin(m_stringIndices) + static_cast<std::ptrdiff_t>(
+        std::min((blockIndex + 1U) * TERMINAL_BLOCK_SIZE, m_stringIndices.size()));
+    const auto minimumMaximum = std::minmax_element(blockBegin, blockEnd);
+    m_terminalBlockRanges[blockIndex] = {*minimumMaximum.first, *minimumMaximum.second};
+  }
+}
+
+size_t FrozenTrie::getNumberOfChildNodes(NodeIndex nodeIndex) const {
+  return m_nodes[nodeIndex + 1U].childBegin - m_nodes[nodeIndex].childBegin;
+}
+
+FrozenTrie::NodeIndex FrozenTrie::getChildNodeIndexAt(
+      NodeIndex nodeIndex,
+      size_t childPosition) const {
+  // child nodes are sorted by key
+  return m_childNodeIndices[m_nodes[nodeIndex].childBegin + childPosition];
+}
+
+FrozenTrie::NodeIndex FrozenTrie::getChildNodeIndex(
+      NodeIndex nodeIndex,
+      unsigned char key) const {
+  // the position of the child node is the number of child keys that are smaller than key;
+  // it's computed without data-dependent branches, so that random prefixes don't cause
+  // branch mispredictions (the branches on the number of child nodes are mostly predictable,
+  // as the nodes below the first few levels have only few child nodes)
+  const FrozenNode& node{m_nodes[nodeIndex]};
+  const size_t numberOfChildNodes{getNumberOfChildNodes(nodeIndex)};
+  size_t childPosition{0U};
+  bool found{false};
+
+  if (numberOfChildNodes <= MAXIMUM_NUMBER_OF_INLINE_CHILD_KEYS) {
+    // small node: the keys are stored in the node itself
+    for (size_t i = 0U; i < MAXIMUM_NUMBER_OF_INLINE_CHILD_KEYS; i++) {
+      const unsigned char childKey{static_cast<unsigned char>(
+          (node.childLookup >> (i * numberOfBitsPerByte)) & byteMask)};
+      const size_t isValid{static_cast<size_t>(i < numberOfChildNodes)};
+      childPosition += isValid & static_cast<size_t>(childKey < key);
+      found = found || ((isValid & static_cast<size_t>(childKey == key)) != 0U);
+    }
+  } else {
+#ifdef __SSE2__
+    // the index of the child node is loaded after the keys have been searched, so the cache
+    // line is requested in the meantime
+    _mm_prefetch(reinterpret_cast<const char*>(&m_childNodeIndices[node.childBegin]),
+        _MM_HINT_T0);
+#endif
+
+    if (numberOfChildNodes >= MINIMUM_NUMBER_OF_CHILD_NODES_FOR_BITMAP) {
+      // dense node: count the set bits in the bitmap before the bit of key
+      const ChildBitmap& childBitmap{m_childBitmaps[node.childLookup]};
+      const size_t keyWordIndex{key / bitmapWordSize};
+      const std::uint64_t keyBit{std::uint64_t{1U} << (key % bitmapWordSize)};
+
+      for (size_t wordIndex = 0U; wordIndex < NUMBER_OF_BITMAP_WORDS; wordIndex++) {
+        // all bits for words before the word of key, the bits before the bit of key
+        // for the word of key, and no bits for words after the word of key
+        const std::uint64_t mask{(wordIndex < keyWordIndex) ? ~std::uint64_t{0U}
+            : ((wordIndex == keyWordIndex) ? (keyBit - 1U) : std::uint64_t{0U})};
+        childPosition += std::bitset<bitmapWordSize>{childBitmap[wordIndex] & mask}.count();
+      }
+
+      found = ((childBitmap[keyWordIndex] & keyBit) != 0U);
+    } else {
+      // sparse node: the child keys are sorted
+      const unsigned char* childKeys{&m_childKeys[node.childBegin]};
+
+#ifdef __SSE2__
+      static_assert(MINIMUM_NUMBER_OF_CHILD_NODES_FOR_BITMAP - 1U <= keyVectorSize,
+          "Sparse nodes must fit into a single key vector.");
+
+      // the vector load reads keyVectorSize keys, which is only possible if they don't exceed
+      // the end of m_childKeys (i.e., for all but the last few nodes)
+      if (node.childBegin + keyVectorSize <= m_childKeys.size()) {
+        found = findSparseChildKeyVectorized(childKeys, numberOfChildNodes, key, childPosition);
+      } else
+#endif
+      {
+        found = findSparseChildKey(childKeys, numberOfChildNodes, key, childPosition);
+      }
+    }
+  }
+
+  if (!found) {
+    return INVALID_NODE_INDEX;
+  }
+
+  // the first child node directly follows the node in preorder, so its index doesn't have to
+  // be loaded
+  return (childPosition == 0U) ? (nodeIndex + 1U)
+      : m_childNodeIndices[node.childBegin + childPosition];
+}
+
+FrozenTrie::NodeIndex FrozenTrie::getDescendantNodeIndexForPrefix(
+      const std::string& prefix) const {
+  NodeIndex nodeIndex{0U};
+  size_t position{0U};
+
+  if ((m_rootTableDepth > 0U) && (prefix.length() >= m_rootTableDepth)) {
+    size_t rootTableIndex{0U};
+
+    for (; position < m_rootTableDepth; position++) {
+      rootTableIndex = rootTableIndex * rootTableRadix
+          + static_cast<unsigned char>(prefix[position]);
+    }
+
+    nodeIndex = m_rootTable[rootTableIndex];
+
+    if (nodeIndex == INVALID_NODE_INDEX) {
+      return INVALID_NODE_INDEX;
+    }
+  }
+
+  for (; position < prefix.length(); position++) {
+    nodeIndex = getChildNodeIndex(nodeIndex, static_cast<unsigned char>(prefix[position]));
+
+    if (nodeIndex == INVALID_NODE_INDEX) {
+      return INVALID_NODE_INDEX;
+    }
+  }
+
+  return nodeIndex;
+}
+
+size_t FrozenTrie::getStringIndex(NodeIndex nodeIndex) const {
+  // the node stores a string if and only if the next node in preorder (or the sentinel)
+  // has a larger terminalBegin
+  const std::uint32_t terminalBegin{m_nodes[nodeIndex].terminalBegin};
+  return (m_nodes[nodeIndex + 1U].terminalBegin > terminalBegin)
+      ? m_stringIndices[terminalBegin] : Node::INVALID_STRING_INDEX;
+}
+
+FrozenTrie::CountEstimate FrozenTrie::estimateCount(const std::string& prefix) const {
+  // short prefixes: one lookup in the histogram of their length
+  if (prefix.length() <= m_rootTableDepth) {
+    size_t histogramIndex{0U};
+
+    for (const char& character : prefix) {
+      histogramIndex = histogramIndex * rootTableRadix + static_cast<unsigned char>(character);
+    }
+
+    return {m_prefixCountHistograms[prefix.length()][histogramIndex], true};
+  }
+
+  // longer prefixes: descend for at most MAXIMUM_NUMBER_OF_ESTIMATION_STEPS more characters,
+  // so that the number of accessed cache lines is bounded
+  const size_t descentLength{std::min(
+      prefix.length(), m_rootTableDepth + MAXIMUM_NUMBER_OF_ESTIMATION_STEPS)};
+  const NodeIndex nodeIndex{getDescendantNodeIndexForPrefix(prefix.substr(0U, descentLength))};
+
+  if (nodeIndex == INVALID_NODE_INDEX) {
+    return {0U, true};
+  }
+
+  const size_t numberOfStrings{getNumberOfStringsInSubtree(nodeIndex)};
+  const size_t numberOfChildNodes{getNumberOfChildNodes(nodeIndex)};
+
+  if ((descentLength == prefix.length()) || (numberOfChildNodes == 0U)) {
+    return {(descentLength == prefix.length()) ? numberOfStrings : 0U, true};
+  }
+
+  // assume that the strings are distributed evenly among the child nodes for each of the
+  // remaining characters
+  double estimatedCount{static_cast<double>(numberOfStrings)};
+
+  for (size_t i = descentLength; i < prefix.length(); i++) {
+    estimatedCount /= static_cast<double>(numberOfChildNodes);
+  }
+
+  return {static_cast<size_t>(std::lround(estimatedCount)), false};
+}
+
+std::vector<FrozenTrie::NextCharacter> FrozenTrie::getNextCharacters(
+      const std::string& prefix) const {
+  const NodeIndex nodeIndex{getDescendantNodeIndexForPrefix(prefix)};
+  std::vector<NextCharacter> nextCharacters;
+
+  if (nodeIndex == INVALID_NODE_INDEX) {
+    return nextCharacters;
+  }
+
+  const size_t numberOfChildNodes{getNumberOfChildNodes(nodeIndex)};
+  nextCharacters.reserve(numberOfChildNodes);
+
+  // the child nodes are sorted by key
+  for (size_t childPosition = 0U; childPosition < numberOfChildNodes; childPosition++) {
+    nextCharacters.push_back({m_childKeys[m_nodes[nodeIndex].childBegin + childPosition],
+        getNumberOfStringsInSubtree(getChildNodeIndexAt(nodeIndex, childPosition))});
+  }
+
+  return nextCharacters;
+}
+
+std::string FrozenTrie::getLongestUnambiguousExtension(const std::string& prefix) const {
+  // returns prefix extended by the characters that all strings with the prefix share
+  // (e.g., for tab completion), or prefix itself if no string has the prefix
+  NodeIndex nodeIndex{getDescendantNodeIndexForPrefix(prefix)};
+  std::string extendedPrefix{prefix};
+
+  if (nodeIndex == INVALID_NODE_INDEX) {
+    return extendedPrefix;
+  }
+
+  // stop at nodes that store a string or branch
+  while ((getStringIndex(nodeIndex) == Node::INVALID_STRING_INDEX)
+        && (getNumberOfChildNodes(nodeIndex) == 1U)) {
+    extendedPrefix.push_back(static_cast<char>(m_childKeys[m_nodes[nodeIndex].childBegin]));
+    nodeIndex = getChildNodeIndexAt(nodeIndex, 0U);
+  }
+
+  return extendedPrefix;
+}
+
+size_t FrozenTrie::getNumberOfStringsInSubtree(NodeIndex nodeIndex) const {
+  return m_nodes[m_nodes[nodeIndex].subtreeEnd].terminalBegin - m_nodes[nodeIndex].terminalBegin;
+}
+
+size_t FrozenTrie::encode(const std::string& string) const {
+  const NodeIndex nodeIndex{getDescendantNodeIndexForPrefix(string)};
+
+  // the ID of a string is the number of strings preceding it in preorder
+  if ((nodeIndex == INVALID_NODE_INDEX)
+        || (m_nodes[nodeIndex + 1U].terminalBegin == m_nodes[nodeIndex].terminalBegin)) {
+    return INVALID_ID;
+  }
+
+  return m_nodes[nodeIndex].terminalBegin;
+}
+
+std::string FrozenTrie::decode(size_t id) const {
+  if (id >= getNumberOfStrings()) {
+    throw std::out_of_range("ID " + std::to_string(id) + " is not in the frozen trie.");
+  }
+
+  // the node storing the string is the last node (in preorder) whose terminalBegin is id
+  // (the sentinel has a larger terminalBegin, so the search always succeeds)
+  const NodeIndex stringNodeIndex{static_cast<NodeIndex>(std::upper_bound(
+      std::begin(m_nodes), std::end(m_nodes), id, [](size_t value, const FrozenNode& node) {
+        return value < node.terminalBegin;
+      }) - std::begin(m_nodes) - 1)};
+
+  // descend to the node: as subtrees are contiguous, the next node on the path is the last
+  // child node whose index is not larger than the index of the node
+  std::string string;
+  NodeIndex nodeIndex{0U};
+
+  while (nodeIndex != stringNodeIndex) {
+    const auto childBegin = std::begin(m_childNodeIndices) + m_nodes[nodeIndex].childBegin;
+    const auto childEnd = childBegin
+        + static_cast<std::ptrdiff_t>(getNumberOfChildNodes(nodeIndex));
+    const auto childIt = std::upper_bound(childBegin, childEnd, stringNodeIndex) - 1;
+    string.push_back(static_cast<char>(
+        m_childKeys[static_cast<size_t>(childIt - std::begin(m_childNodeIndices))]));
+    nodeIndex = *childIt;
+  }
+
+  return string;
+}
+
+size_t FrozenTrie::getStringIndexForId(size_t id) const {
+  return m_stringIndices.at(id);
+}
+
+size_t FrozenTrie::rank(const std::string& string) const {
+  NodeIndex nodeIndex{0U};
+
+  for (const char& character : string) {
+    const unsigned char key{static_cast<unsigned char>(character)};
+    const auto childKeysBegin = std::begin(m_childKeys) + m_nodes[nodeIndex].childBegin;
+    const auto childKeysEnd = childKeysBegin
+        + static_cast<std::ptrdiff_t>(getNumberOfChildNodes(nodeIndex));
+    const auto childKeyIt = std::lower_bound(childKeysBegin, childKeysEnd, key);
+
+    if (childKeyIt == childKeysEnd) {
+      // all strings in the subtree are smaller
+      return m_nodes[m_nodes[nodeIndex].subtreeEnd].terminalBegin;
+    }
+
+    const NodeIndex childNodeIndex{m_childNodeIndices[
+        static_cast<size_t>(childKeyIt - std::begin(m_childKeys))]};
+
+    if (*childKeyIt != key) {
+      // the strings before the subtree of the first child node with a larger key are smaller
+      return m_nodes[childNodeIndex].terminalBegin;
+    }
+
+    nodeIndex = childNodeIndex;
+  }
+
+  // the strings in the subtree of the node are not smaller (the string of the node is equal)
+  return m_nodes[nodeIndex].terminalBegin;
+}
+
+std::string FrozenTrie::select(size_t rank) const {
+  return decode(rank);
+}
+
+std::pair<size_t, size_t> FrozenTrie::getIdRangeForPrefix(const std::string& prefix) const {
+  const NodeIndex nodeIndex{getDescendantNodeIndexForPrefix(prefix)};
+
+  if (nodeIndex == INVALID_NODE_INDEX) {
+    return {0U, 0U};
+  }
+
+  return {m_nodes[nodeIndex].terminalBegin, m_nodes[m_nodes[nodeIndex].subtreeEnd].terminalBegin};
+}
+
+std::vector<size_t> FrozenTrie::searchPrefix(const std::string& prefix) const {
+  const NodeIndex nodeIndex{getDescendantNodeIndexForPrefix(prefix)};
+
+  if (nodeIndex == INVALID_NODE_INDEX) {
+    return {};
+  }
+
+  // the subtree is contiguous, so the matches are contiguous as well
+  const std::uint32_t terminalBegin{m_nodes[nodeIndex].terminalBegin};
+  const std::uint32_t terminalEnd{m_nodes[m_nodes[nodeIndex].subtreeEnd].terminalBegin};
+  return std::vector<size_t>(
+      std::begin(m_stringIndices) + static_cast<std::ptrdiff_t>(terminalBegin),
+      std::begin(m_stringIndices) + static_cast<std::ptrdiff_t>(terminalEnd));
+}
+
+std::vector<size_t> FrozenTrie::searchPrefix(
+      const std::string& prefix,
+      const StringIndexFilter& filter) const {
+  const NodeIndex nodeIndex{getDescendantNodeIndexForPrefix(prefix)};
+  std::vector<size_t> stringIndices;
+
+  if (nodeIndex == INVALID_NODE_INDEX) {
+    return stringIndices;
+  }
+
+  // the matches are a contiguous range of m_stringIndices; blocks of the range whose string
+  // indices don't intersect the filter are skipped, and only the others are tested one by one
+  const size_t terminalEnd{m_nodes[m_nodes[nodeIndex].subtreeEnd].terminalBegin};
+  size_t terminalIndex{m_nodes[nodeIndex].terminalBegin};
+
+  while (terminalIndex < terminalEnd) {
+    const size_t blockIndex{terminalIndex / TERMINAL_BLOCK_SIZE};
+    const size_t blockBegin{blockIndex * TERMINAL_BLOCK_SIZE};
+    const size_t blockEnd{std::min(blockBegin + TERMINAL_BLOCK_SIZE, terminalEnd)};
+    const StringIndexRange& blockRange{m_terminalBlockRanges[blockIndex]};
+
+    // the range of a block is only valid if the whole block is part of the matches
+    if ((terminalIndex == blockBegin) && (blockEnd == blockBegin + TERMINAL_BLOCK_SIZE)
+          && !filter.mayIntersect(blockRange.minimum, blockRange.maximum)) {
+      terminalIndex = blockEnd;
+      continue;
+    }
+
+    for (; terminalIndex < blockEnd; terminalIndex++) {
+      if (filter.contains(m_stringIndices[terminalIndex])) {
+        stringIndices.push_back(m_stringIndices[terminalIndex]);
+      }
+    }
+  }
+
+  return stringIndices;
+}
+
+std::vector<size_t> FrozenTrie::searchPrefixShortestFirst(
+      const std::string& prefix,
+      size_t maximumNumberOfMatches) const {
+  // as the child nodes are sorted, matches of the same length are in lexicographical order
+  return searchShortestFirst<NodeIndex>(getDescendantNodeIndexForPrefix(prefix), INVALID_NODE_INDEX,
+      maximumNumberOfMatches,
+      [this](NodeIndex nodeIndex) {
+        return getStringIndex(nodeIndex);
+      },
+      [this](NodeIndex nodeIndex, std::vector<NodeIndex>& nodeIndices) {
+        const auto childBegin = std::begin(m_childNodeIndices) + m_nodes[nodeIndex].childBegin;
+        nodeIndices.insert(std::end(nodeIndices), childBegin,
+            childBegin + static_cast<std::ptrdiff_t>(getNumberOfChildNodes(nodeIndex)));
+      });
+}
+
+DeepestPrefixMatches FrozenTrie::searchDeepestPrefix(
+      const std::string& prefix,
+      size_t maximumNumberOfMatches) const {
+  // the root table isn't used, as its entry is invalid if the path ends before its depth
+  DeepestPrefixMatches matches;
+  NodeIndex nodeIndex{0U};
+
+  for (const char& character : prefix) {
+    const NodeIndex childNodeIndex{
+        getChildNodeIndex(nodeIndex, static_cast<unsigned char>(character))};
+
+    if (childNodeIndex == INVALID_NODE_INDEX) {
+      break;
+    }
+
+    nodeIndex = childNodeIndex;
+    matches.prefixLength++;
+  }
+
+  // the first matches in lexicographical order
+  const size_t terminalBegin{m_nodes[nodeIndex].terminalBegin};
+  const size_t numberOfMatches{
+      std::min(getNumberOfStringsInSubtree(nodeIndex), maximumNumberOfMatches)};
+  matches.stringIndices.assign(
+      std::begin(m_stringIndices) + static_cast<std::ptrdiff_t>(terminalBegin),
+      std::begin(m_stringIndices) + static_cast<std::ptrdiff_t>(terminalBegin + numberOfMatches));
+  return matches;
+}
+
+std::vector<size_t> FrozenTrie::samplePrefix(
+      const std::string& prefix,
+      size_t numberOfSamples,
+      std::default_random_engine& randomNumberGenerator) const {
+  const std::pair<size_t, size_t> idRange{getIdRangeForPrefix(prefix)};
+  const size_t numberOfMatches{idRange.second - idRange.first};
+
+  if (numberOfSamples >= numberOfMatches) {
+    return searchPrefix(prefix);
+  }
+
+  // the matches are the contiguous range of IDs, so it suffices to sample distinct positions
+  // in the range (with Floyd's algorithm, which takes numberOfSamples random numbers)
+  std::unordered_set<size_t> positionSet;
+
+  for (size_t j = numberOfMatches - numberOfSamples; j < numberOfMatches; j++) {
+    std::uniform_int_distribution<size_t> positionDistribution{0U, j};
+    const size_t position{positionDistribution(randomNumberGenerator)};
+
+    if (!positionSet.insert(position).second) {
+      positionSet.insert(j);
+    }
+  }
+
+  // return the samples in lexicographical order
+  std::vector<size_t> positions(std::begin(positionSet), std::end(positionSet));
+  std::sort(std::begin(positions), std::end(positions));
+  std::vector<size_t> stringIndices;
+  stringIndices.reserve(numberOfSamples);
+
+  for (const size_t& position : positions) {
+    stringIndices.push_back(m_stringIndices[idRange.first + position]);
+  }
+
+  return stringIndices;
+}
+
+std::vector<size_t> FrozenTrie::countPrefixes(const std::vector<std::string>& prefixes) const {
+  const std::vector<NodeIndex> descendantNodeIndices{descendSortedPrefixes(prefixes)};
+  std::vector<size_t> counts(prefixes.size(), 0U);
+
+  for (size_t prefixIndex = 0U; prefixIndex < prefixes.size(); prefixIndex++) {
+    if (descendantNodeIndices[prefixIndex] != INVALID_NODE_INDEX) {
+      counts[prefixIndex] = getNumberOfStringsInSubtree(descendantNodeIndices[prefixIndex]);
+    }
+  }
+
+  return counts;
+}
+
+PrefixSearchResults FrozenTrie::searchPrefixesSorted(
+      const std::vector<std::string>& prefixes) const {
+  const std::vector<NodeIndex> descendantNodeIndices{descendSortedPrefixes(prefixes)};
+  PrefixSearchResults results;
+  results.offsets.reserve(prefixes.size() + 1U);
+
+  // the sizes of the results are known in advance, so the arena is allocated only once
+  for (const NodeIndex& nodeIndex : descendantNodeIndices) {
+    results.offsets.push_back(results.offsets.back()
+        + ((nodeIndex != INVALID_NODE_INDEX) ? getNumberOfStringsInSubtree(nodeIndex) : 0U));
+  }
+
+  results.stringIndices.resize(results.offsets.back());
+
+  for (size_t prefixIndex = 0U; prefixIndex < prefixes.size(); prefixIndex++) {
+    const NodeIndex nodeIndex{descendantNodeIndices[prefixIndex]};
+
+    if (nodeIndex != INVALID_NODE_INDEX) {
+      std::copy_n(std::begin(m_stringIndices) + m_nodes[nodeIndex].terminalBegin,
+          results.getNumberOfMatches(prefixIndex),
+          std::begin(results.stringIndices)
+            + static_cast<std::ptrdiff_t>(results.offsets[prefixIndex]));
+    }
+  }
+
+  return results;
+}
+
+std::vector<FrozenTrie::NodeIndex> FrozenTrie::descendSortedPrefixes(
+      const std::vector<std::string>& prefixes) const {
+  // the root table isn't used, as the sorted descent only takes one step for most prefixes
+  return trie::descendSortedPrefixes<NodeIndex>(prefixes, 0U, INVALID_NODE_INDEX,
+      [this](NodeIndex nodeIndex, unsigned char key) {
+        return getChildNodeIndex(nodeIndex, key);
+      });
+}
+
+void FrozenTrie::thaw(Node& rootNode) const {
+  // recreate the nodes below rootNode, with the child nodes sorted by key
+  std::vector<std::pair<NodeIndex, Node*>> stack{{0U, &rootNode}};
+
+  while (!stack.empty()) {
+    const NodeIndex nodeIndex{stack.back().first};
+    Node* node{stack.back().second};
+    stack.pop_back();
+
+    const size_t numberOfChildNodes{getNumberOfChildNodes(nodeIndex)};
+    node->setStringIndex(getStringIndex(nodeIndex));
+    node->reserveChildNodes(numberOfChildNodes);
+
+    for (size_t childPosition = 0U; childPosition < numberOfChildNodes; childPosition++) {
+      node->appendChildNode(m_childKeys[m_nodes[nodeIndex].childBegin + childPosition],
+          std::make_unique<Node>());
+      stack.emplace_back(getChildNodeIndexAt(nodeIndex, childPosition),
+          node->getChildNodeAt(childPosition));
+    }
+  }
+}
+
+void FrozenTrie::save(const std::string& path) const {
+  // the arrays are stored as they are (in little endian), so they can be loaded without decoding
+  // any nodes
+  constexpr size_t numberOfSections = 4U;
+  std::vector<std::string> sections(numberOfSections);
+
+  #pragma omp parallel sections default(none) shared(sections)
+  {
+    #pragma omp section
+    {
+      // the child lookups and the root table are not stored, but recreated when loading
+      // (the number of child nodes is implied by the childBegin of the next node)
+      sections[0U].reserve(m_nodes.size() * frozenNodeSize);
+
+      for (const FrozenNode& node : m_nodes) {
+        const FrozenNodeRecord record{{node.childBegin, node.terminalBegin, node.subtreeEnd}};
+        TrieFile::appendFixedArray(record.data(), record.size(), 4U, sections[0U]);
+      }
+    }
+
+    #pragma omp section
+    sections[1U].assign(std::begin(m_childKeys), std::end(m_childKeys));
+
+    #pragma omp section
+    TrieFile::appendFixedArray(m_childNodeIndices.data(), m_childNodeIndices.size(),
+        sizeof(NodeIndex), sections[2U]);
+
+    #pragma omp section
+    TrieFile::appendFixedArray(m_stringIndices.data(), m_stringIndices.size(),
+        sizeof(std::uint64_t), sections[3U]);
+  }
+
+  TrieFile::write(path, TrieFile::FileType::frozenTrie,
+      {TrieFile::SectionType::frozenNodes, TrieFile::SectionType::childKeys,
+        TrieFile::SectionType::childNodeIndices, TrieFile::SectionType::stringIndices},
+      sections);
+}
+
+FrozenTrie FrozenTrie::load(
+      const std::string& path,
+      size_t rootTableDepth,
+      const std::vector<std::string>& patchPaths) {
+  TrieFile file{path, TrieFile::FileType::frozenTrie};
+  const std::vector<std::string> sections{file.readAllSections()};
+  FrozenTrie frozenTrie;
+  frozenTrie.m_nodes.clear();
+
+  for (size_t sectionIndex = 0U; sectionIndex < sections.size(); sectionIndex++) {
+    const std::string& section{sections[sectionIndex]};
+    size_t position{0U};
+
+    switch (file.getSectionType(sectionIndex)) {
+      case TrieFile::SectionType::frozenNodes: {
+        checkConsistency(section.size() % frozenNodeSize == 0U);
+        frozenTrie.m_nodes.resize(section.size() / frozenNodeSize);
+
+        for (FrozenNode& node : frozenTrie.m_nodes) {
+          FrozenNodeRecord record;
+          TrieFile::readFixedArray(section, position, 4U, record.data(), record.size());
+          node.childBegin = record[0U];
+          node.terminalBegin = record[1U];
+          node.subtreeEnd = record[2U];
+          node.childLookup = INVALID_CHILD_LOOKUP;
+        }
+
+        break;
+      }
+      case TrieFile::SectionType::childKeys: {
+        frozenTrie.m_childKeys.assign(std::begin(section), std::end(section));
+        break;
+      }
+      case TrieFile::SectionType::childNodeIndices: {
+        checkConsistency(section.size() % sizeof(NodeIndex) == 0U);
+        frozenTrie.m_childNodeIndices.resize(section.size() / sizeof(NodeIndex));
+        TrieFile::readFixedArray(section, position, sizeof(NodeIndex),
+            frozenTrie.m_childNodeIndices.data(), frozenTrie.m_childNodeIndices.size());
+        break;
+      }
+      case TrieFile::SectionType::stringIndices: {
+        checkConsistency(section.size() % sizeof(std::uint64_t) == 0U);
+        frozenTrie.m_stringIndices.resize(section.size() / sizeof(std::uint64_t));
+        TrieFile::readFixedArray(section, position, sizeof(std::uint64_t),
+            frozenTrie.m_stringIndices.data(), frozenTrie.m_stringIndices.size());
+        break;
+      }
+      default: {
+        throw std::runtime_error("Unexpected section in frozen trie file \"" + path + "\".");
+      }
+    }
+  }
+
+  // check that the arrays describe a trie in preorder, so that corrupt files don't lead to
+  // invalid accesses or wrong results
+  const std::vector<FrozenNode>& nodes{frozenTrie.m_nodes};
+  const std::vector<unsigned char>& childKeys{frozenTrie.m_childKeys};
+  const std::vector<NodeIndex>& childNodeIndices{frozenTrie.m_childNodeIndices};
+  checkConsistency((nodes.size() >= 2U) && (nodes.size() - 1U < INVALID_NODE_INDEX));
+  const NodeIndex numberOfNodes{frozenTrie.getNumberOfNodes()};
+  const FrozenNode& sentinel{nodes[numberOfNodes]};
+
+  // every node except the root node has one child entry
+  checkConsistency((childKeys.size() == numberOfNodes - 1U)
+      && (childNodeIndices.size() == numberOfNodes - 1U)
+      && (nodes[0U].childBegin == 0U) && (nodes[0U].terminalBegin == 0U)
+      && (nodes[0U].subtreeEnd == numberOfNodes)
+      && (sentinel.childBegin == childKeys.size())
+      && (sentinel.terminalBegin == frozenTrie.m_stringIndices.size()));
+
+  for (NodeIndex nodeIndex = 0U; nodeIndex < numberOfNodes; nodeIndex++) {
+    const FrozenNode& node{nodes[nodeIndex]};
+    const FrozenNode& nextNode{nodes[nodeIndex + 1U]};
+
+    // each node stores at most one string
+    checkConsistency((nextNode.childBegin >= node.childBegin)
+        && (nextNode.terminalBegin >= node.terminalBegin)
+        && (nextNode.terminalBegin - node.terminalBegin <= 1U)
+        && (node.subtreeEnd > nodeIndex) && (node.subtreeEnd <= numberOfNodes));
+  }
+
+  for (NodeIndex nodeIndex = 0U; nodeIndex < numberOfNodes; nodeIndex++) {
+    // the subtrees of the child nodes (sorted by key) follow the node without gaps and end
+    // where the subtree of the node ends, so that the subtrees are nested
+    const FrozenNode& node{nodes[nodeIndex]};
+    NodeIndex nextChildNodeIndex{nodeIndex + 1U};
+
+    for (size_t childIndex = node.childBegin; childIndex < nodes[nodeIndex + 1U].childBegin;
+          childIndex++) {
+      checkConsistency((nextChildNodeIndex < numberOfNodes)
+          && (childNodeIndices[childIndex] == nextChildNodeIndex)
+          && ((childIndex == node.childBegin)
+            || (childKeys[childIndex - 1U] < childKeys[childIndex])));
+      nextChildNodeIndex = nodes[nextChildNodeIndex].subtreeEnd;
+    }
+
+    checkConsistency(nextChildNodeIndex == node.subtreeEnd);
+  }
+
+  if (!patchPaths.empty()) {
+    // the flat arrays can't be updated in place, so the nodes are thawed into a mutable trie,
+    // the patches are applied like in Trie::load, and the trie is frozen again
+    Trie trie;
+    frozenTrie.thaw(trie.getRootNode());
+
+    for (const std::string& patchPath : patchPaths) {
+      trie.applyPatch(TriePatch::load(patchPath));
+    }
+
+    return trie.freeze(rootTableDepth);
+  }
+
+  frozenTrie.createChildLookups();
+  frozenTrie.createRootTable(rootTableDepth);
+  frozenTrie.createTerminalBlockRanges();
+  return frozenTrie;
+}
+
+}  // namespace trie
@@ -0,0 +1,187 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_FROZENTRIE_HPP
+#define TRIE_FROZENTRIE_HPP
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trie/MemoryUsage.hpp"
+#include "trie/Node.hpp"
+#include "trie/PrefixDescent.hpp"
+#include "trie/StringIndexFilter.hpp"
+
+namespace trie {
+
+// Immutable, read-optimized version of a trie, created with Trie::freeze.
+//
+// The nodes are stored in a single flat array in preorder, with the child nodes of each node
+// sorted by key. Therefore, the subtree of a node is a contiguous range of nodes, and the string
+// indices stored in a subtree are a contiguous range of m_stringIndices (in lexicographical order
+// of the strings). The keys and indices of the child nodes of each node are stored contiguously
+// in m_childKeys and m_childNodeIndices. Nodes with few child nodes additionally store the keys
+// of their child nodes in the node itself, and nodes with many child nodes have a bitmap of the
+// keys of their child nodes, so that the child node for a key can be found without branching;
+// the keys of other nodes are compared with the key at once using SIMD instructions (if
+// available). Optionally, the nodes at depth k (for a small k) are stored in a table indexed
+// by the first k bytes of the prefix, so that the first k levels of a descent are a single
+// lookup. The position of a string in m_stringIndices is its rank in lexicographical order,
+// which is used as its ID for dictionary encoding (so the IDs of the strings with a common
+// prefix are a contiguous range).
+class FrozenTrie {
+  public:
+    using NodeIndex = std::uint32_t;
+
+    static constexpr NodeIndex INVALID_NODE_INDEX = std::numeric_limits<NodeIndex>::max();
+    static constexpr size_t INVALID_ID = std::numeric_limits<size_t>::max();
+    // depth of the root table (256^depth entries, i.e., 256 KiB for depth 2)
+    static constexpr size_t DEFAULT_ROOT_TABLE_DEPTH = 2U;
+    static constexpr size_t MAXIMUM_ROOT_TABLE_DEPTH = 3U;
+    // number of characters after the root table for which estimateCount descends
+    static constexpr size_t MAXIMUM_NUMBER_OF_ESTIMATION_STEPS = 2U;
+
+    // estimated number of strings with a prefix
+    struct CountEstimate {
+      size_t count;
+      bool isExact;
+    };
+
+    // possible next character after a prefix, with the number of strings continuing with it
+    struct NextCharacter {
+      unsigned char character;
+      size_t count;
+    };
+
+    FrozenTrie();
+    explicit FrozenTrie(
+        const Node& rootNode,
+        size_t rootTableDepth = DEFAULT_ROOT_TABLE_DEPTH);
+
+    NodeIndex getNumberOfNodes() const;
+    size_t getNumberOfStrings() const;
+    MemoryUsage getMemoryUsage() const;
+
+    size_t getNumberOfChildNodes(NodeIndex nodeIndex) const;
+    NodeIndex getChildNodeIndexAt(NodeIndex nodeIndex, size_t childPosition) const;
+    NodeIndex getChildNodeIndex(NodeIndex nodeIndex, unsigned char key) const;
+    NodeIndex getDescendantNodeIndexForPrefix(const std::string& prefix) const;
+    size_t getStringIndex(NodeIndex nodeIndex) const;
+
+    size_t getNumberOfStringsInSubtree(NodeIndex nodeIndex) const;
+    CountEstimate estimateCount(const std::string& prefix) const;
+    std::vector<NextCharacter> getNextCharacters(const std::string& prefix) const;
+    std::string getLongestUnambiguousExtension(const std::string& prefix) const;
+
+    // dense IDs of the strings in lexicographical order
+    size_t encode(const std::string& string) const;
+    std::string decode(size_t id) const;
+    size_t getStringIndexForId(size_t id) const;
+    std::pair<size_t, size_t> getIdRangeForPrefix(const std::string& prefix) const;
+
+    // order statistics: number of strings that are lexicographically smaller than string, and
+    // the string with the given rank (i.e., the string with the ID rank)
+    size_t rank(const std::string& string) const;
+    std::string select(size_t rank) const;
+
+    std::vector<size_t> searchPrefix(const std::string& prefix) const;
+    std::vector<size_t> searchPrefix(
+        const std::string& prefix,
+        const StringIndexFilter& filter) const;
+    std::vector<size_t> samplePrefix(
+        const std::string& prefix,
+        size_t numberOfSamples,
+        std::default_random_engine& randomNumberGenerator) const;
+    std::vector<size_t> searchPrefixShortestFirst(
+        const std::string& prefix,
+        size_t maximumNumberOfMatches = std::numeric_limits<size_t>::max()) const;
+    DeepestPrefixMatches searchDeepestPrefix(
+        const std::string& prefix,
+        size_t maximumNumberOfMatches = std::numeric_limits<size_t>::max()) const;
+    std::vector<size_t> countPrefixes(const std::vector<std::string>& prefixes) const;
+    PrefixSearchResults searchPrefixesSorted(const std::vector<std::string>& prefixes) const;
+
+    void save(const std::string& path) const;
+    static FrozenTrie load(
+        const std::string& path,
+        size_t rootTableDepth = DEFAULT_ROOT_TABLE_DEPTH,
+        const std::vector<std::string>& patchPaths = {});
+
+  private:
+    struct FrozenNode {
+      // index of the first child of this node in m_childKeys and m_childNodeIndices
+      // (the child entries are allocated in preorder, so the child entries of this node end
+      // where the child entries of the next node begin)
+      std::uint32_t childBegin;
+      // number of strings stored in the nodes preceding this node (in preorder)
+      std::uint32_t terminalBegin;
+      // index of the first node after the subtree of this node (in preorder)
+      NodeIndex subtreeEnd;
+      // for nodes with at most MAXIMUM_NUMBER_OF_INLINE_CHILD_KEYS child nodes (i.e., most nodes
+      // below the first few levels), the keys of the child nodes (the i-th key in the i-th least
+      // significant byte), so that a descent doesn't have to access m_childKeys; for nodes with at
+      // least MINIMUM_NUMBER_OF_CHILD_NODES_FOR_BITMAP child nodes, the index in m_childBitmaps;
+      // INVALID_CHILD_LOOKUP for all other nodes
+      std::uint32_t childLookup;
+    };
+
+    static constexpr size_t NUMBER_OF_BITMAP_WORDS = 4U;
+    static constexpr std::uint32_t INVALID_CHILD_LOOKUP =
+        std::numeric_limits<std::uint32_t>::max();
+    static constexpr size_t MAXIMUM_NUMBER_OF_INLINE_CHILD_KEYS = sizeof(std::uint32_t);
+    // minimum number of child nodes for which a bitmap is created (for fewer child nodes, the
+    // keys are compared directly)
+    static constexpr size_t MINIMUM_NUMBER_OF_CHILD_NODES_FOR_BITMAP = 17U;
+
+    using ChildBitmap = std::array<std::uint64_t, NUMBER_OF_BITMAP_WORDS>;
+
+    // number of consecutive entries of m_stringIndices that are summarized by their range
+    static constexpr size_t TERMINAL_BLOCK_SIZE = 64U;
+
+    struct StringIndexRange {
+      size_t minimum;
+      size_t maximum;
+    };
+
+    void createChildLookups();
+    void createRootTable(size_t rootTableDepth);
+    void createTerminalBlockRanges();
+    std::vector<NodeIndex> descendSortedPrefixes(const std::vector<std::string>& prefixes) const;
+    void thaw(Node& rootNode) const;
+
+    void freezeSubtree(
+        const Node& rootNode,
+        NodeIndex nodeIndex,
+        std::uint32_t childBegin,
+        std::uint32_t terminalBegin);
+
+    // contains an additional sentinel node at the end
+    std::vector<FrozenNode> m_nodes;
+    std::vector<unsigned char> m_childKeys;
+    std::vector<NodeIndex> m_childNodeIndices;
+    std::vector<size_t> m_stringIndices;
+    std::vector<ChildBitmap> m_childBitmaps;
+    size_t m_rootTableDepth{0U};
+    // index of the node for each possible prefix of length m_rootTableDepth (interpreted as a
+    // big-endian number), or INVALID_NODE_INDEX if there is no such node
+    std::vector<NodeIndex> m_rootTable;
+    // number of strings for each possible prefix of length 0, 1, ..., m_rootTableDepth
+    // (indexed like m_rootTable)
+    std::vector<std::vector<std::uint32_t>> m_prefixCountHistograms;
+    // minimum and maximum string index of each block of TERMINAL_BLOCK_SIZE entries of
+    // m_stringIndices, used to skip blocks when searching with a filter
+    std::vector<StringIndexRange> m_terminalBlockRanges;
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_FROZENTRIE_HPP
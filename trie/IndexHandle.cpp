@@ -0,0 +1,153 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "trie/FrozenTrie.hpp"
+#include "trie/IndexHandle.hpp"
+#include "trie/Trie.hpp"
+
+namespace trie {
+
+template <typename Index>
+IndexHandle<Index>::IndexHandle()
+      : m_reclaimer{std::make_shared<Reclaimer>()},
+      m_reclaimerThread{runReclaimer, m_reclaimer} {
+}
+
+template <typename Index>
+IndexHandle<Index>::IndexHandle(std::unique_ptr<Index> index) : IndexHandle() {
+  publish(std::move(index));
+}
+
+template <typename Index>
+IndexHandle<Index>::~IndexHandle() {
+  // queries that still hold a generation after this point destroy it themselves
+  // (the reclaimer state outlives the handle, as it is shared with the deleters)
+  std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>{});
+
+  {
+    const std::lock_guard<std::mutex> lock{m_reclaimer->mutex};
+    m_reclaimer->stopped = true;
+  }
+
+  m_reclaimer->condition.notify_all();
+  m_reclaimerThread.join();
+}
+
+template <typename Index>
+std::shared_ptr<const Index> IndexHandle<Index>::acquire() const {
+  return acquireSnapshot().index;
+}
+
+template <typename Index>
+typename IndexHandle<Index>::Snapshot IndexHandle<Index>::acquireSnapshot() const {
+  const std::shared_ptr<const Snapshot> snapshot{std::atomic_load(&m_snapshot)};
+  return (snapshot != nullptr) ? *snapshot : Snapshot{nullptr, 0U};
+}
+
+template <typename Index>
+void IndexHandle<Index>::publish(std::unique_ptr<Index> index) {
+  const std::lock_guard<std::mutex> publishLock{m_publishMutex};
+
+  {
+    const std::lock_guard<std::mutex> lock{m_reclaimer->mutex};
+    m_reclaimer->numberOfLiveGenerations++;
+  }
+
+  // instead of deleting the index, the deleter hands it over to the reclaimer thread,
+  // so that the query that drops the last reference doesn't have to pay for the destruction
+  const std::shared_ptr<Reclaimer> reclaimer{m_reclaimer};
+  std::shared_ptr<const Index> newIndex{index.release(),
+      [reclaimer](const Index* indexToRetire) { retire(reclaimer, indexToRetire); }};
+
+  // the index and its generation number are swapped in with one atomic store, so that no query
+  // sees the new index with the old number or vice versa; in-flight queries keep using the old
+  // generation via their own references (publishing is serialized by m_publishMutex, so the
+  // snapshot can't change between the load and the store)
+  const std::shared_ptr<const Snapshot> snapshot{std::make_shared<Snapshot>(
+      Snapshot{std::move(newIndex), acquireSnapshot().generation + 1U})};
+  std::atomic_store(&m_snapshot, snapshot);
+}
+
+template <typename Index>
+size_t IndexHandle<Index>::getGeneration() const {
+  return acquireSnapshot().generation;
+}
+
+template <typename Index>
+size_t IndexHandle<Index>::getNumberOfLiveGenerations() const {
+  const std::lock_guard<std::mutex> lock{m_reclaimer->mutex};
+  return m_reclaimer->numberOfLiveGenerations;
+}
+
+template <typename Index>
+void IndexHandle<Index>::waitForReclamation(size_t maximumNumberOfLiveGenerations) const {
+  // loaders can call this before building the next generation to bound the memory usage
+  std::unique_lock<std::mutex> lock{m_reclaimer->mutex};
+  m_reclaimer->condition.wait(lock, [this, maximumNumberOfLiveGenerations]() {
+        return (m_reclaimer->numberOfLiveGenerations <= maximumNumberOfLiveGenerations);
+      });
+}
+
+template <typename Index>
+void IndexHandle<Index>::runReclaimer(const std::shared_ptr<Reclaimer>& reclaimer) {
+  std::unique_lock<std::mutex> lock{reclaimer->mutex};
+
+  while (true) {
+    reclaimer->condition.wait(lock, [&reclaimer]() {
+          return (reclaimer->stopped || !reclaimer->indicesToDestroy.empty());
+        });
+
+    if (reclaimer->indicesToDestroy.empty()) {
+      // stopped and nothing left to destroy
+      return;
+    }
+
+    std::vector<std::unique_ptr<const Index>> indicesToDestroy{
+        std::move(reclaimer->indicesToDestroy)};
+    reclaimer->indicesToDestroy.clear();
+
+    // destroy the indices without holding the lock, so that retiring isn't blocked
+    lock.unlock();
+    const size_t numberOfDestroyedIndices{indicesToDestroy.size()};
+    indicesToDestroy.clear();
+    lock.lock();
+
+    reclaimer->numberOfLiveGenerations -= numberOfDestroyedIndices;
+    reclaimer->condition.notify_all();
+  }
+}
+
+template <typename Index>
+void IndexHandle<Index>::retire(const std::shared_ptr<Reclaimer>& reclaimer, const Index* index) {
+  std::unique_ptr<const Index> indexToRetire{index};
+  std::unique_lock<std::mutex> lock{reclaimer->mutex};
+
+  if (reclaimer->stopped) {
+    // the reclaimer thread has already finished, destroy the index in the calling thread
+    reclaimer->numberOfLiveGenerations--;
+    lock.unlock();
+    indexToRetire.reset();
+    return;
+  }
+
+  reclaimer->indicesToDestroy.push_back(std::move(indexToRetire));
+  lock.unlock();
+  reclaimer->condition.notify_all();
+}
+
+// the handle is only used with these index types, so it is instantiated here instead of being
+// defined in the header
+template class IndexHandle<Trie>;
+template class IndexHandle<FrozenTrie>;
+
+}  // namespace trie
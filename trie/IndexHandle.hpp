@@ -0,0 +1,74 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_INDEXHANDLE_HPP
+#define TRIE_INDEXHANDLE_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "trie/FrozenTrie.hpp"
+#include "trie/Trie.hpp"
+
+namespace trie {
+
+// Holds the current generation of an immutable index (Trie or FrozenTrie). Queries acquire a
+// reference to the current generation, while a loader thread publishes new generations; old
+// generations are destroyed by a background thread as soon as the last query using them has
+// finished.
+template <typename Index>
+class IndexHandle {
+  public:
+    // a generation and its number, published together, so that they always match
+    struct Snapshot {
+      std::shared_ptr<const Index> index;
+      size_t generation;
+    };
+
+    IndexHandle();
+    explicit IndexHandle(std::unique_ptr<Index> index);
+    IndexHandle(const IndexHandle&) = delete;
+    IndexHandle(IndexHandle&&) = delete;
+    IndexHandle& operator=(const IndexHandle&) = delete;
+    IndexHandle& operator=(IndexHandle&&) = delete;
+    ~IndexHandle();
+
+    std::shared_ptr<const Index> acquire() const;
+    Snapshot acquireSnapshot() const;
+    void publish(std::unique_ptr<Index> index);
+
+    size_t getGeneration() const;
+    size_t getNumberOfLiveGenerations() const;
+    void waitForReclamation(size_t maximumNumberOfLiveGenerations = 1U) const;
+
+  private:
+    struct Reclaimer {
+      std::mutex mutex;
+      std::condition_variable condition;
+      std::vector<std::unique_ptr<const Index>> indicesToDestroy;
+      size_t numberOfLiveGenerations{0U};
+      bool stopped{false};
+    };
+
+    static void runReclaimer(const std::shared_ptr<Reclaimer>& reclaimer);
+    static void retire(const std::shared_ptr<Reclaimer>& reclaimer, const Index* index);
+
+    std::shared_ptr<Reclaimer> m_reclaimer;
+    std::thread m_reclaimerThread;
+    std::shared_ptr<const Snapshot> m_snapshot;
+    std::mutex m_publishMutex;
+};
+
+using TrieHandle = IndexHandle<Trie>;
+using FrozenTrieHandle = IndexHandle<FrozenTrie>;
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_INDEXHANDLE_HPP
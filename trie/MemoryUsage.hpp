@@ -0,0 +1,80 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_MEMORYUSAGE_HPP
+#define TRIE_MEMORYUSAGE_HPP
+
+#include <algorithm>
+#include <cstddef>
+
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace trie {
+
+// Breakdown of the heap memory used by a trie (all sizes in bytes).
+struct MemoryUsage {
+  size_t numberOfNodes{0U};
+  // size of the Node objects themselves
+  size_t nodeHeaders{0U};
+  // used entries of the child node arrays
+  size_t childArrays{0U};
+  // unused capacity of the child node arrays
+  size_t slack{0U};
+  // strings owned by the trie
+  size_t payloads{0U};
+  // bookkeeping and rounding of the allocator
+  size_t allocatorOverhead{0U};
+
+  size_t getTotal() const {
+    return nodeHeaders + childArrays + slack + payloads + allocatorOverhead;
+  }
+
+  MemoryUsage& operator+=(const MemoryUsage& other) {
+    numberOfNodes += other.numberOfNodes;
+    nodeHeaders += other.nodeHeaders;
+    childArrays += other.childArrays;
+    slack += other.slack;
+    payloads += other.payloads;
+    allocatorOverhead += other.allocatorOverhead;
+    return *this;
+  }
+
+  // Returns the overhead of the allocator for an allocation of the given size. If
+  // measureAllocations is true and the allocator supports it, the actual size of the allocation
+  // is queried; otherwise, it is estimated (one size_t header, rounded up to 16 bytes, with a
+  // minimum of 32 bytes, like glibc on 64-bit platforms).
+  static size_t getAllocatorOverhead(
+        const void* pointer,
+        size_t requestedSize,
+        bool measureAllocations) {
+    constexpr size_t allocationHeaderSize = sizeof(size_t);
+
+#ifdef __GLIBC__
+    if (measureAllocations) {
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
+      return malloc_usable_size(const_cast<void*>(pointer)) + allocationHeaderSize
+          - requestedSize;
+    }
+#else
+    static_cast<void>(pointer);
+    static_cast<void>(measureAllocations);
+#endif
+
+    constexpr size_t allocationAlignment = 16U;
+    constexpr size_t minimumAllocationSize = 32U;
+    const size_t allocationSize{std::max(minimumAllocationSize,
+        (requestedSize + allocationHeaderSize + allocationAlignment - 1U)
+        / allocationAlignment * allocationAlignment)};
+    return allocationSize - requestedSize;
+  }
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_MEMORYUSAGE_HPP
@@ -12,11 +12,12 @@
 #include <iostream>
 #include <limits>
 #include <memory>
-#include <numeric>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "trie/MemoryUsage.hpp"
+
 namespace trie {
 
 class Node {
@@ -26,6 +27,26 @@ class Node {
   public:
     static constexpr size_t INVALID_STRING_INDEX = std::numeric_limits<size_t>::max();
 
+    Node() = default;
+    Node(const Node&) = delete;
+    Node(Node&&) = default;
+    Node& operator=(const Node&) = delete;
+    Node& operator=(Node&&) = default;
+
+    ~Node() {
+      // destroy the subtree iteratively instead of recursively via the destructors of the
+      // unique_ptrs, as the latter overflows the stack for long chains of nodes
+      std::vector<std::unique_ptr<Node>> nodesToDestroy;
+      releaseChildNodes(nodesToDestroy);
+
+      while (!nodesToDestroy.empty()) {
+        std::unique_ptr<Node> node{std::move(nodesToDestroy.back())};
+        nodesToDestroy.pop_back();
+        node->releaseChildNodes(nodesToDestroy);
+        // node doesn't have any child nodes at this point and is destroyed non-recursively
+      }
+    }
+
     size_t getStringIndex() const {
       return m_stringIndex;
     }
@@ -35,15 +56,61 @@ class Node {
     }
 
     size_t getSizeInMemory() const {
-      // account for size of this, the size of the heap memory reserved by m_keysAndChildNodes,
-      // and the size of the heap memory reserved by the child node unique_ptrs
-      return sizeof(Node)
-          + m_keysAndChildNodes.size() * sizeof(KeyChildNodePair)
-          + std::accumulate(std::begin(m_keysAndChildNodes), std::end(m_keysAndChildNodes), 0U,
-            [](size_t sizeInMemory,
-                  const KeyChildNodePair& keyChildNodePair) {
-              return sizeInMemory + keyChildNodePair.second->getSizeInMemory();
-            });
+      MemoryUsage memoryUsage;
+      addMemoryUsage(memoryUsage);
+      return memoryUsage.getTotal();
+    }
+
+    void addMemoryUsage(MemoryUsage& memoryUsage, bool measureAllocations = false) const {
+      // traverse the subtree iteratively (instead of recursively) to keep the stack size constant
+      std::vector<const Node*> stack{this};
+
+      while (!stack.empty()) {
+        const Node* node{stack.back()};
+        stack.pop_back();
+        node->addOwnMemoryUsage(memoryUsage, measureAllocations);
+
+        for (const KeyChildNodePair& keyChildNodePair : node->m_keysAndChildNodes) {
+          if (keyChildNodePair.second) {
+            stack.push_back(keyChildNodePair.second.get());
+          }
+        }
+      }
+    }
+
+    void addOwnMemoryUsage(MemoryUsage& memoryUsage, bool measureAllocations = false) const {
+      // account for the node itself (which has been allocated on the heap) and for the heap
+      // memory reserved by m_keysAndChildNodes (based on its capacity, not its size)
+      memoryUsage.numberOfNodes++;
+      memoryUsage.nodeHeaders += sizeof(Node);
+      memoryUsage.allocatorOverhead += MemoryUsage::getAllocatorOverhead(
+          this, sizeof(Node), measureAllocations);
+
+      if (m_keysAndChildNodes.capacity() > 0U) {
+        memoryUsage.childArrays += m_keysAndChildNodes.size() * sizeof(KeyChildNodePair);
+        memoryUsage.slack += (m_keysAndChildNodes.capacity() - m_keysAndChildNodes.size())
+            * sizeof(KeyChildNodePair);
+        memoryUsage.allocatorOverhead += MemoryUsage::getAllocatorOverhead(
+            m_keysAndChildNodes.data(),
+            m_keysAndChildNodes.capacity() * sizeof(KeyChildNodePair),
+            measureAllocations);
+      }
+    }
+
+    size_t getNumberOfChildNodes() const {
+      return m_keysAndChildNodes.size();
+    }
+
+    unsigned char getChildKeyAt(size_t childIndex) const {
+      return m_keysAndChildNodes[childIndex].first;
+    }
+
+    const Node* getChildNodeAt(size_t childIndex) const {
+      return m_keysAndChildNodes[childIndex].second.get();
+    }
+
+    Node* getChildNodeAt(size_t childIndex) {
+      return m_keysAndChildNodes[childIndex].second.get();
     }
 
     const Node* getChildNode(unsigned char key) const {
@@ -76,6 +143,42 @@ class Node {
       }
     }
 
+    void reserveChildNodes(size_t numberOfChildNodes) {
+      m_keysAndChildNodes.reserve(numberOfChildNodes);
+    }
+
+    void appendChildNode(unsigned char key, std::unique_ptr<Node> node) {
+      // caller has to ensure that there is no child node with the same key yet
+      m_keysAndChildNodes.emplace_back(key, std::move(node));
+    }
+
+    std::unique_ptr<Node> replaceChildNodeAt(size_t childIndex, std::unique_ptr<Node> node) {
+      std::swap(m_keysAndChildNodes[childIndex].second, node);
+      return node;
+    }
+
+    void shrinkChildNodesToFit() {
+      m_keysAndChildNodes.shrink_to_fit();
+    }
+
+    void removeChildNode(unsigned char key) {
+      const auto it = findKey(key);
+
+      if (it != std::end(m_keysAndChildNodes)) {
+        m_keysAndChildNodes.erase(it);
+      }
+    }
+
+    void releaseChildNodes(std::vector<std::unique_ptr<Node>>& childNodes) {
+      for (KeyChildNodePair& keyChildNodePair : m_keysAndChildNodes) {
+        if (keyChildNodePair.second) {
+          childNodes.push_back(std::move(keyChildNodePair.second));
+        }
+      }
+
+      std::vector<KeyChildNodePair>{}.swap(m_keysAndChildNodes);
+    }
+
     const Node* getDescendantNodeForPrefix(const std::string& prefix) const {
       const Node* currentNode{this};
 
@@ -91,6 +194,28 @@ class Node {
       return currentNode;
     }
 
+    // returns the deepest node on the path of prefix and sets prefixLength to its depth
+    // (i.e., the length of the longest prefix of prefix that is a path in the trie)
+    const Node* getDeepestDescendantNodeForPrefix(
+          const std::string& prefix,
+          size_t& prefixLength) const {
+      const Node* currentNode{this};
+      prefixLength = 0U;
+
+      for (const char& character : prefix) {
+        const Node* childNode{currentNode->getChildNode(static_cast<unsigned char>(character))};
+
+        if (childNode == nullptr) {
+          break;
+        }
+
+        currentNode = childNode;
+        prefixLength++;
+      }
+
+      return currentNode;
+    }
+
     void print(size_t indentationLevel = 0U) const {
       std::cout << "Node" << std::endl;
 
@@ -106,16 +231,45 @@ class Node {
       }
     }
 
-    void collectStringIndices(std::vector<size_t>& stringIndices) const {
+    // appends the string indices in the subtree of this node, until stringIndices contains
+    // maximumNumberOfStringIndices entries
+    void collectStringIndices(
+          std::vector<size_t>& stringIndices,
+          size_t maximumNumberOfStringIndices = std::numeric_limits<size_t>::max()) const {
+      if (stringIndices.size() >= maximumNumberOfStringIndices) {
+        return;
+      }
+
       if (m_stringIndex != INVALID_STRING_INDEX) {
         stringIndices.push_back(m_stringIndex);
       }
 
       for (const KeyChildNodePair& keyChildNodePair : m_keysAndChildNodes) {
         if (keyChildNodePair.second) {
-          keyChildNodePair.second->collectStringIndices(stringIndices);
+          keyChildNodePair.second->collectStringIndices(
+              stringIndices, maximumNumberOfStringIndices);
+        }
+      }
+    }
+
+    // returns the number of strings stored in the subtree of this node
+    size_t countStrings() const {
+      size_t numberOfStrings{0U};
+      std::vector<const Node*> stack{this};
+
+      while (!stack.empty()) {
+        const Node* node{stack.back()};
+        stack.pop_back();
+        numberOfStrings += static_cast<size_t>(node->m_stringIndex != INVALID_STRING_INDEX);
+
+        for (const KeyChildNodePair& keyChildNodePair : node->m_keysAndChildNodes) {
+          if (keyChildNodePair.second) {
+            stack.push_back(keyChildNodePair.second.get());
+          }
         }
       }
+
+      return numberOfStrings;
     }
 
   protected:
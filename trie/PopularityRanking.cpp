@@ -0,0 +1,222 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trie/FrozenTrie.hpp"
+#include "trie/Node.hpp"
+#include "trie/PopularityRanking.hpp"
+
+namespace trie {
+
+namespace {
+
+size_t getNumberOfStringIndices(const FrozenTrie& frozenTrie) {
+  size_t numberOfStringIndices{0U};
+
+  for (FrozenTrie::NodeIndex nodeIndex = 0U; nodeIndex < frozenTrie.getNumberOfNodes();
+        nodeIndex++) {
+    const size_t stringIndex{frozenTrie.getStringIndex(nodeIndex)};
+
+    if (stringIndex != Node::INVALID_STRING_INDEX) {
+      numberOfStringIndices = std::max(numberOfStringIndices, stringIndex + 1U);
+    }
+  }
+
+  return numberOfStringIndices;
+}
+
+void checkDecayFactor(double decayFactor) {
+  // negated, so that NaN is rejected as well
+  if (!((decayFactor >= 0.0) && (decayFactor <= 1.0))) {
+    throw std::invalid_argument("Decay factor " + std::to_string(decayFactor)
+        + " is not between 0 and 1.");
+  }
+}
+
+}  // namespace
+
+PopularityRanking::PopularityRanking(const FrozenTrie& frozenTrie)
+      : m_frozenTrie{frozenTrie}, m_counters(getNumberOfStringIndices(frozenTrie)) {
+  update();
+}
+
+PopularityRanking::~PopularityRanking() {
+  stopPeriodicUpdates();
+}
+
+void PopularityRanking::increment(size_t stringIndex, std::uint64_t amount) {
+  if (stringIndex >= m_counters.size()) {
+    throw std::out_of_range("String index " + std::to_string(stringIndex)
+        + " is not in the trie.");
+  }
+
+  m_counters[stringIndex].fetch_add(amount, std::memory_order_relaxed);
+}
+
+std::uint64_t PopularityRanking::getCount(size_t stringIndex) const {
+  if (stringIndex >= m_counters.size()) {
+    throw std::out_of_range("String index " + std::to_string(stringIndex)
+        + " is not in the trie.");
+  }
+
+  return m_counters[stringIndex].load(std::memory_order_relaxed);
+}
+
+void PopularityRanking::update(double decayFactor) {
+  checkDecayFactor(decayFactor);
+  const std::lock_guard<std::mutex> lock{m_updateMutex};
+  std::shared_ptr<Snapshot> snapshot{std::make_shared<Snapshot>()};
+  snapshot->counts.resize(m_counters.size());
+
+  for (size_t stringIndex = 0U; stringIndex < m_counters.size(); stringIndex++) {
+    std::atomic<std::uint64_t>& counter{m_counters[stringIndex]};
+    std::uint64_t count{counter.load(std::memory_order_relaxed)};
+
+    if (decayFactor != 1.0) {
+      // increments that happen concurrently are not lost, but decayed in the next pass
+      std::uint64_t decayedCount{0U};
+
+      do {
+        decayedCount = static_cast<std::uint64_t>(static_cast<double>(count) * decayFactor);
+      } while (!counter.compare_exchange_weak(count, decayedCount, std::memory_order_relaxed));
+
+      count = decayedCount;
+    }
+
+    snapshot->counts[stringIndex] = count;
+  }
+
+  // the child nodes of a node come after it in preorder, so visiting the nodes in reverse
+  // preorder computes the maxima of the child nodes first
+  const FrozenTrie::NodeIndex numberOfNodes{m_frozenTrie.getNumberOfNodes()};
+  snapshot->subtreeMaxima.resize(numberOfNodes);
+
+  for (FrozenTrie::NodeIndex nodeIndex = numberOfNodes; nodeIndex-- > 0U;) {
+    const size_t stringIndex{m_frozenTrie.getStringIndex(nodeIndex)};
+    std::uint64_t subtreeMaximum{
+        (stringIndex != Node::INVALID_STRING_INDEX) ? snapshot->counts[stringIndex] : 0U};
+
+    for (size_t childPosition = 0U;
+          childPosition < m_frozenTrie.getNumberOfChildNodes(nodeIndex); childPosition++) {
+      subtreeMaximum = std::max(subtreeMaximum, snapshot->subtreeMaxima[
+          m_frozenTrie.getChildNodeIndexAt(nodeIndex, childPosition)]);
+    }
+
+    snapshot->subtreeMaxima[nodeIndex] = subtreeMaximum;
+  }
+
+  // running topK queries keep using the previous snapshot
+  std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>{std::move(snapshot)});
+}
+
+void PopularityRanking::startPeriodicUpdates(
+      std::chrono::milliseconds interval,
+      double decayFactor) {
+  // check in the calling thread, as exceptions must not escape the background thread
+  checkDecayFactor(decayFactor);
+  stopPeriodicUpdates();
+  m_updateThreadStopped = false;
+
+  m_updateThread = std::thread{[this, interval, decayFactor]() {
+        std::unique_lock<std::mutex> lock{m_updateThreadMutex};
+
+        while (!m_updateThreadCondition.wait_for(lock, interval,
+              [this]() { return m_updateThreadStopped; })) {
+          lock.unlock();
+          update(decayFactor);
+          lock.lock();
+        }
+      }};
+}
+
+void PopularityRanking::stopPeriodicUpdates() {
+  if (!m_updateThread.joinable()) {
+    return;
+  }
+
+  {
+    const std::lock_guard<std::mutex> lock{m_updateThreadMutex};
+    m_updateThreadStopped = true;
+  }
+
+  m_updateThreadCondition.notify_all();
+  m_updateThread.join();
+}
+
+std::vector<size_t> PopularityRanking::topK(const std::string& prefix, size_t k) const {
+  const std::shared_ptr<const Snapshot> snapshot{std::atomic_load(&m_snapshot)};
+  const FrozenTrie::NodeIndex descendantNodeIndex{
+      m_frozenTrie.getDescendantNodeIndexForPrefix(prefix)};
+  std::vector<size_t> stringIndices;
+
+  if ((descendantNodeIndex == FrozenTrie::INVALID_NODE_INDEX) || (k == 0U)) {
+    return stringIndices;
+  }
+
+  // best-first search: an entry is either a subtree (ranked by its maximum count) or the string
+  // of a node (ranked by its count); a string is returned as soon as it is the best entry, as
+  // no remaining subtree can contain a string with a higher count
+  struct Entry {
+    std::uint64_t count;
+    FrozenTrie::NodeIndex nodeIndex;
+    bool isString;
+  };
+
+  // ties are broken by preorder (i.e., lexicographical order), with the string of a node
+  // before its subtree
+  const auto isWorse = [](const Entry& entry1, const Entry& entry2) {
+        if (entry1.count != entry2.count) {
+          return (entry1.count < entry2.count);
+        } else if (entry1.nodeIndex != entry2.nodeIndex) {
+          return (entry1.nodeIndex > entry2.nodeIndex);
+        } else {
+          return (!entry1.isString && entry2.isString);
+        }
+      };
+
+  std::priority_queue<Entry, std::vector<Entry>, decltype(isWorse)> queue{isWorse};
+  queue.push({snapshot->subtreeMaxima[descendantNodeIndex], descendantNodeIndex, false});
+
+  while (!queue.empty() && (stringIndices.size() < k)) {
+    const Entry entry{queue.top()};
+    queue.pop();
+
+    if (entry.isString) {
+      stringIndices.push_back(m_frozenTrie.getStringIndex(entry.nodeIndex));
+      continue;
+    }
+
+    const size_t stringIndex{m_frozenTrie.getStringIndex(entry.nodeIndex)};
+
+    if (stringIndex != Node::INVALID_STRING_INDEX) {
+      queue.push({snapshot->counts[stringIndex], entry.nodeIndex, true});
+    }
+
+    for (size_t childPosition = 0U;
+          childPosition < m_frozenTrie.getNumberOfChildNodes(entry.nodeIndex);
+          childPosition++) {
+      const FrozenTrie::NodeIndex childNodeIndex{
+          m_frozenTrie.getChildNodeIndexAt(entry.nodeIndex, childPosition)};
+      queue.push({snapshot->subtreeMaxima[childNodeIndex], childNodeIndex, false});
+    }
+  }
+
+  return stringIndices;
+}
+
+}  // namespace trie
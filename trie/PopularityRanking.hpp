@@ -0,0 +1,72 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_POPULARITYRANKING_HPP
+#define TRIE_POPULARITYRANKING_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trie/FrozenTrie.hpp"
+
+namespace trie {
+
+// Ranks the strings of a frozen trie by popularity. Queries increment the counters of strings
+// concurrently; an update pass (called manually or periodically by a background thread) decays
+// the counters and propagates them to the maximum count of each subtree, which is used by topK
+// to only visit the subtrees that can contain the most popular matches. topK reflects the counts
+// as of the last update pass. Decay factors must be between 0 and 1. The frozen trie must outlive
+// the ranking.
+class PopularityRanking {
+  public:
+    explicit PopularityRanking(const FrozenTrie& frozenTrie);
+    PopularityRanking(const PopularityRanking&) = delete;
+    PopularityRanking(PopularityRanking&&) = delete;
+    PopularityRanking& operator=(const PopularityRanking&) = delete;
+    PopularityRanking& operator=(PopularityRanking&&) = delete;
+    ~PopularityRanking();
+
+    void increment(size_t stringIndex, std::uint64_t amount = 1U);
+    std::uint64_t getCount(size_t stringIndex) const;
+
+    void update(double decayFactor = 1.0);
+    void startPeriodicUpdates(std::chrono::milliseconds interval, double decayFactor);
+    void stopPeriodicUpdates();
+
+    std::vector<size_t> topK(const std::string& prefix, size_t k) const;
+
+  private:
+    // counts as of an update pass
+    struct Snapshot {
+      // indexed by string index
+      std::vector<std::uint64_t> counts;
+      // indexed by node index
+      std::vector<std::uint64_t> subtreeMaxima;
+    };
+
+    const FrozenTrie& m_frozenTrie;
+    // relaxed atomics, as increments don't have to be ordered with respect to anything else
+    std::vector<std::atomic<std::uint64_t>> m_counters;
+    std::shared_ptr<const Snapshot> m_snapshot;
+    std::mutex m_updateMutex;
+
+    std::thread m_updateThread;
+    std::mutex m_updateThreadMutex;
+    std::condition_variable m_updateThreadCondition;
+    bool m_updateThreadStopped{false};
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_POPULARITYRANKING_HPP
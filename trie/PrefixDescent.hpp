@@ -0,0 +1,156 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_PREFIXDESCENT_HPP
+#define TRIE_PREFIXDESCENT_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "trie/Node.hpp"
+
+namespace trie {
+
+// Results of a batch of prefix searches: the string indices for all prefixes are stored in one
+// arena, and the string indices for the prefix with index i are stored in the range from
+// offsets[i] to offsets[i + 1] (exclusive).
+struct PrefixSearchResults {
+  std::vector<size_t> stringIndices;
+  std::vector<size_t> offsets{0U};
+
+  size_t getNumberOfPrefixes() const {
+    return offsets.size() - 1U;
+  }
+
+  size_t getNumberOfMatches(size_t prefixIndex) const {
+    return offsets[prefixIndex + 1U] - offsets[prefixIndex];
+  }
+
+  std::vector<size_t> getMatches(size_t prefixIndex) const {
+    return std::vector<size_t>(
+        std::begin(stringIndices) + static_cast<std::ptrdiff_t>(offsets[prefixIndex]),
+        std::begin(stringIndices) + static_cast<std::ptrdiff_t>(offsets[prefixIndex + 1U]));
+  }
+};
+
+// Result of a prefix search that falls back to the longest prefix of the query that is a path
+// in the trie (prefixLength is its length, and stringIndices are its matches).
+struct DeepestPrefixMatches {
+  size_t prefixLength{0U};
+  std::vector<size_t> stringIndices;
+};
+
+// Returns the node for each of the prefixes (or invalidNode if the prefix is not in the trie).
+// The prefixes are visited in sorted order, and the path of the previous prefix is kept, so
+// that prefixes with a common beginning share the descent for it (e.g., "ab" and "ac" only
+// take one step each after the descent for "a"). getChildNode(node, key) has to return the
+// child node of node for key, or invalidNode.
+template <typename NodeReference, typename GetChildNode>
+std::vector<NodeReference> descendSortedPrefixes(
+      const std::vector<std::string>& prefixes,
+      NodeReference rootNode,
+      NodeReference invalidNode,
+      const GetChildNode& getChildNode) {
+  std::vector<size_t> prefixOrder(prefixes.size());
+  std::iota(std::begin(prefixOrder), std::end(prefixOrder), 0U);
+  std::sort(std::begin(prefixOrder), std::end(prefixOrder),
+      [&prefixes](size_t prefixIndex1, size_t prefixIndex2) {
+        return prefixes[prefixIndex1] < prefixes[prefixIndex2];
+      });
+
+  std::vector<NodeReference> descendantNodes(prefixes.size(), invalidNode);
+  // path[depth] is the node for the first depth characters of the previous prefix
+  std::vector<NodeReference> path{rootNode};
+  const std::string* previousPrefix{nullptr};
+
+  for (const size_t& prefixIndex : prefixOrder) {
+    const std::string& prefix{prefixes[prefixIndex]};
+    size_t depth{0U};
+
+    if (previousPrefix != nullptr) {
+      const size_t maximumDepth{std::min(
+          {prefix.length(), previousPrefix->length(), path.size() - 1U})};
+
+      while ((depth < maximumDepth) && (prefix[depth] == (*previousPrefix)[depth])) {
+        depth++;
+      }
+    }
+
+    path.erase(std::begin(path) + static_cast<std::ptrdiff_t>(depth) + 1, std::end(path));
+
+    for (; depth < prefix.length(); depth++) {
+      const NodeReference childNode{
+          getChildNode(path.back(), static_cast<unsigned char>(prefix[depth]))};
+
+      if (childNode == invalidNode) {
+        break;
+      }
+
+      path.push_back(childNode);
+    }
+
+    if (path.size() == prefix.length() + 1U) {
+      descendantNodes[prefixIndex] = path.back();
+    }
+
+    previousPrefix = &prefix;
+  }
+
+  return descendantNodes;
+}
+
+// Returns at most maximumNumberOfMatches string indices of the subtree of descendantNode (which
+// may be invalidNode), shorter strings first. The subtree is searched breadth-first, one depth
+// (i.e., string length) at a time; the next depth is only expanded if the strings found so far
+// don't suffice. getStringIndex(node) has to return the string index of node (or
+// Node::INVALID_STRING_INDEX), and appendChildNodes(node, nodes) has to append the child nodes
+// of node to nodes.
+template <typename NodeReference, typename GetStringIndex, typename AppendChildNodes>
+std::vector<size_t> searchShortestFirst(
+      NodeReference descendantNode,
+      NodeReference invalidNode,
+      size_t maximumNumberOfMatches,
+      const GetStringIndex& getStringIndex,
+      const AppendChildNodes& appendChildNodes) {
+  std::vector<size_t> stringIndices;
+  std::vector<NodeReference> currentNodes;
+  std::vector<NodeReference> nextNodes;
+
+  if (descendantNode != invalidNode) {
+    currentNodes.push_back(descendantNode);
+  }
+
+  while (!currentNodes.empty() && (stringIndices.size() < maximumNumberOfMatches)) {
+    for (const NodeReference& node : currentNodes) {
+      const size_t stringIndex{getStringIndex(node)};
+
+      if (stringIndex != Node::INVALID_STRING_INDEX) {
+        stringIndices.push_back(stringIndex);
+
+        if (stringIndices.size() == maximumNumberOfMatches) {
+          return stringIndices;
+        }
+      }
+    }
+
+    for (const NodeReference& node : currentNodes) {
+      appendChildNodes(node, nextNodes);
+    }
+
+    currentNodes.swap(nextNodes);
+    nextNodes.clear();
+  }
+
+  return stringIndices;
+}
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_PREFIXDESCENT_HPP
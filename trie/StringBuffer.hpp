@@ -0,0 +1,72 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_STRINGBUFFER_HPP
+#define TRIE_STRINGBUFFER_HPP
+
+#include <string>
+#include <vector>
+
+namespace trie {
+
+class StringBuffer {
+  public:
+    void reserve(size_t numberOfStrings, size_t numberOfCharacters) {
+      m_characters.reserve(numberOfCharacters);
+      m_offsets.reserve(numberOfStrings + 1U);
+    }
+
+    void shrinkToFit() {
+      m_characters.shrink_to_fit();
+      m_offsets.shrink_to_fit();
+    }
+
+    void append(const std::string& string) {
+      m_characters.append(string);
+      m_offsets.push_back(m_characters.size());
+    }
+
+    void append(const std::string& string, size_t position, size_t length) {
+      m_characters.append(string, position, length);
+      m_offsets.push_back(m_characters.size());
+    }
+
+    size_t size() const {
+      return m_offsets.size() - 1U;
+    }
+
+    bool empty() const {
+      return (size() == 0U);
+    }
+
+    size_t getLength(size_t stringIndex) const {
+      return m_offsets[stringIndex + 1U] - m_offsets[stringIndex];
+    }
+
+    char getCharacter(size_t stringIndex, size_t characterIndex) const {
+      return m_characters[m_offsets[stringIndex] + characterIndex];
+    }
+
+    std::string getString(size_t stringIndex) const {
+      return m_characters.substr(m_offsets[stringIndex], getLength(stringIndex));
+    }
+
+    size_t getHeapSizeInMemory() const {
+      return m_characters.capacity() + m_offsets.capacity() * sizeof(size_t);
+    }
+
+  private:
+    // characters of all strings, concatenated without separators
+    std::string m_characters;
+    // m_offsets[i] is the index of the first character of the i-th string in m_characters,
+    // the last entry is m_characters.size()
+    std::vector<size_t> m_offsets{0U};
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_STRINGBUFFER_HPP
@@ -0,0 +1,107 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_STRINGINDEXFILTER_HPP
+#define TRIE_STRINGINDEXFILTER_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace trie {
+
+// Set of string indices that restricts the results of a prefix search, given either as a sorted
+// list of string indices or as a bitmap (bit i is set if and only if string index i is in the
+// set).
+class StringIndexFilter {
+  public:
+    explicit StringIndexFilter(std::vector<size_t> sortedStringIndices)
+          : m_sortedStringIndices{std::move(sortedStringIndices)} {
+      if (!std::is_sorted(std::begin(m_sortedStringIndices), std::end(m_sortedStringIndices))) {
+        throw std::invalid_argument("String indices of filter are not sorted.");
+      }
+    }
+
+    explicit StringIndexFilter(const std::vector<bool>& bitmap)
+          : m_isBitmap{true}, m_bitmapSize{bitmap.size()},
+          m_bitmapWords((bitmap.size() + WORD_SIZE - 1U) / WORD_SIZE, 0U) {
+      for (size_t stringIndex = 0U; stringIndex < bitmap.size(); stringIndex++) {
+        if (bitmap[stringIndex]) {
+          m_bitmapWords[stringIndex / WORD_SIZE] |=
+              std::uint64_t{1U} << (stringIndex % WORD_SIZE);
+        }
+      }
+    }
+
+    bool contains(size_t stringIndex) const {
+      if (m_isBitmap) {
+        return (stringIndex < m_bitmapSize)
+            && (((m_bitmapWords[stringIndex / WORD_SIZE] >> (stringIndex % WORD_SIZE)) & 1U)
+              != 0U);
+      } else {
+        return std::binary_search(
+            std::begin(m_sortedStringIndices), std::end(m_sortedStringIndices), stringIndex);
+      }
+    }
+
+    // returns false only if no string index from minimumStringIndex to maximumStringIndex
+    // (inclusive) is in the set; may return true even if there is no such string index
+    bool mayIntersect(size_t minimumStringIndex, size_t maximumStringIndex) const {
+      if (m_isBitmap) {
+        if (minimumStringIndex >= m_bitmapSize) {
+          return false;
+        }
+
+        maximumStringIndex = std::min(maximumStringIndex, m_bitmapSize - 1U);
+        const size_t beginWordIndex{minimumStringIndex / WORD_SIZE};
+        const size_t endWordIndex{maximumStringIndex / WORD_SIZE + 1U};
+
+        // wide ranges are not checked, as this would be slower than testing the string indices
+        if (endWordIndex - beginWordIndex > MAXIMUM_NUMBER_OF_CHECKED_WORDS) {
+          return true;
+        }
+
+        for (size_t wordIndex = beginWordIndex; wordIndex < endWordIndex; wordIndex++) {
+          std::uint64_t word{m_bitmapWords[wordIndex]};
+
+          if (wordIndex == beginWordIndex) {
+            word &= ~std::uint64_t{0U} << (minimumStringIndex % WORD_SIZE);
+          }
+
+          if (wordIndex == endWordIndex - 1U) {
+            word &= ~std::uint64_t{0U} >> (WORD_SIZE - 1U - maximumStringIndex % WORD_SIZE);
+          }
+
+          if (word != 0U) {
+            return true;
+          }
+        }
+
+        return false;
+      } else {
+        const auto it = std::lower_bound(std::begin(m_sortedStringIndices),
+            std::end(m_sortedStringIndices), minimumStringIndex);
+        return (it != std::end(m_sortedStringIndices)) && (*it <= maximumStringIndex);
+      }
+    }
+
+  private:
+    static constexpr size_t WORD_SIZE = 64U;
+    static constexpr size_t MAXIMUM_NUMBER_OF_CHECKED_WORDS = 4U;
+
+    bool m_isBitmap{false};
+    std::vector<size_t> m_sortedStringIndices;
+    size_t m_bitmapSize{0U};
+    std::vector<std::uint64_t> m_bitmapWords;
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_STRINGINDEXFILTER_HPP
@@ -5,51 +5,213 @@
  * file, You can obtain one at https://mozilla.org/MPL/2.0/.
  */
 
+#include <algorithm>
+#include <future>
+#include <limits>
 #include <memory>
 #include <numeric>
+#include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include <omp.h>
 
+#include "trie/FrozenTrie.hpp"
 #include "trie/Node.hpp"
+#include "trie/PrefixDescent.hpp"
+#include "trie/StringBuffer.hpp"
 #include "trie/Trie.hpp"
+#include "trie/TrieFile.hpp"
+#include "trie/TriePatch.hpp"
 
 namespace trie {
 
+namespace {
+
+// accessors that allow the construction functions to be used with both
+// std::vector<std::string> and StringBuffer
+
+size_t getNumberOfStrings(const std::vector<std::string>& strings) {
+  return strings.size();
+}
+
+size_t getNumberOfStrings(const StringBuffer& strings) {
+  return strings.size();
+}
+
+size_t getStringLength(const std::vector<std::string>& strings, size_t stringIndex) {
+  return strings[stringIndex].length();
+}
+
+size_t getStringLength(const StringBuffer& strings, size_t stringIndex) {
+  return strings.getLength(stringIndex);
+}
+
+char getStringCharacter(
+      const std::vector<std::string>& strings,
+      size_t stringIndex,
+      size_t characterIndex) {
+  return strings[stringIndex][characterIndex];
+}
+
+char getStringCharacter(const StringBuffer& strings, size_t stringIndex, size_t characterIndex) {
+  return strings.getCharacter(stringIndex, characterIndex);
+}
+
+// returns whether the subtree of node stores a string index in [beginStringIndex, endStringIndex)
+bool containsStringIndexInRange(
+      const Node& node,
+      size_t beginStringIndex,
+      size_t endStringIndex) {
+  std::vector<const Node*> stack{&node};
+
+  while (!stack.empty()) {
+    const Node* currentNode{stack.back()};
+    stack.pop_back();
+    const size_t stringIndex{currentNode->getStringIndex()};
+
+    if ((stringIndex >= beginStringIndex) && (stringIndex < endStringIndex)) {
+      return true;
+    }
+
+    for (size_t childIndex = 0U; childIndex < currentNode->getNumberOfChildNodes();
+          childIndex++) {
+      if (currentNode->getChildNodeAt(childIndex) != nullptr) {
+        stack.push_back(currentNode->getChildNodeAt(childIndex));
+      }
+    }
+  }
+
+  return false;
+}
+
+}  // namespace
+
 Trie::Trie() : m_rootNode{std::make_unique<Node>()} {
 }
 
 Trie::Trie(const std::vector<std::string>& strings, size_t parallelPrefixLength)
       : m_rootNode{std::make_unique<Node>()} {
+  constructFromStrings(strings, parallelPrefixLength);
+}
+
+Trie::Trie(std::vector<std::string>&& strings, size_t parallelPrefixLength)
+      : m_rootNode{std::make_unique<Node>()} {
+  const size_t numberOfCharacters{std::accumulate(
+      std::begin(strings), std::end(strings), size_t{0U},
+      [](size_t sum, const std::string& string) { return sum + string.length(); })};
+  m_strings.reserve(strings.size(), numberOfCharacters);
+
+  // copy the characters to the contiguous buffer and release the heap memory of each string
+  // right away, so that the input strings and the buffer are never stored completely at the
+  // same time
+  for (std::string& string : strings) {
+    m_strings.append(string);
+    std::string{}.swap(string);
+  }
+
+  std::vector<std::string>{}.swap(strings);
+  constructFromStrings(m_strings, parallelPrefixLength);
+}
+
+template <typename Strings>
+void Trie::constructFromStrings(const Strings& strings, size_t parallelPrefixLength) {
+  m_rootNode = std::move(createRootNodes<Strings>({&strings}, parallelPrefixLength)[0U]);
+}
+
+std::vector<Trie> Trie::createTries(
+      const std::vector<const std::vector<std::string>*>& stringSets,
+      size_t parallelPrefixLength) {
+  std::vector<std::unique_ptr<Node>> rootNodes{
+      createRootNodes(stringSets, parallelPrefixLength)};
+  std::vector<Trie> tries(stringSets.size());
+
+  for (size_t setIndex = 0U; setIndex < stringSets.size(); setIndex++) {
+    tries[setIndex].m_rootNode = std::move(rootNodes[setIndex]);
+  }
+
+  return tries;
+}
+
+template <typename Strings>
+std::vector<std::unique_ptr<Node>> Trie::createRootNodes(
+      const std::vector<const Strings*>& stringSets,
+      size_t parallelPrefixLength) {
+  const size_t numberOfSets{stringSets.size()};
+  std::vector<std::unique_ptr<Node>> rootNodes(numberOfSets);
+
   if ((parallelPrefixLength == 0U) || (omp_get_max_threads() == 1)) {
-    for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
-      insertString(strings, stringIndex);
+    for (size_t setIndex = 0U; setIndex < numberOfSets; setIndex++) {
+      rootNodes[setIndex] = std::make_unique<Node>();
+
+      for (size_t stringIndex = 0U; stringIndex < getNumberOfStrings(*stringSets[setIndex]);
+            stringIndex++) {
+        insertStringIntoNode(*rootNodes[setIndex], *stringSets[setIndex], stringIndex, 0U);
+      }
+    }
+
+    return rootNodes;
+  }
+
+  std::vector<std::vector<std::string>> bucketPrefixes(numberOfSets);
+  std::vector<std::vector<std::vector<size_t>>> buckets(numberOfSets);
+  std::vector<std::vector<size_t>> shortStringIndices(numberOfSets);
+  // buckets of all sets as pairs of set index and bucket index, so that the bucket tries of all
+  // sets are created in the same parallel loop
+  std::vector<std::pair<size_t, size_t>> bucketTasks;
+
+  for (size_t setIndex = 0U; setIndex < numberOfSets; setIndex++) {
+    bucketSortStringsInternal(*stringSets[setIndex], nullptr, parallelPrefixLength,
+        bucketPrefixes[setIndex], buckets[setIndex], shortStringIndices[setIndex]);
+
+    for (size_t bucketIndex = 0U; bucketIndex < buckets[setIndex].size(); bucketIndex++) {
+      bucketTasks.emplace_back(setIndex, bucketIndex);
     }
-  } else {
-    std::vector<std::string> bucketPrefixes;
-    std::vector<std::vector<size_t>> buckets;
-    std::vector<size_t> shortStringIndices;
-    bucketSortStrings(strings, parallelPrefixLength, bucketPrefixes, buckets, shortStringIndices);
+  }
+
+  std::vector<std::vector<Trie>> bucketTries(numberOfSets);
 
-    std::vector<Trie> bucketTries{createBucketTries(strings, parallelPrefixLength, buckets)};
+  for (size_t setIndex = 0U; setIndex < numberOfSets; setIndex++) {
+    bucketTries[setIndex].resize(buckets[setIndex].size());
+  }
 
+  // create one trie for each bucket, ignoring the first parallelPrefixLength characters in
+  // each string
+  #pragma omp parallel for default(none) \
+      shared(stringSets, parallelPrefixLength, buckets, bucketTasks, bucketTries) \
+      schedule(dynamic)
+  for (size_t taskIndex = 0U; taskIndex < bucketTasks.size(); taskIndex++) {
+    const size_t setIndex{bucketTasks[taskIndex].first};
+    const size_t bucketIndex{bucketTasks[taskIndex].second};
+    bucketTries[setIndex][bucketIndex] = Trie(*stringSets[setIndex],
+        buckets[setIndex][bucketIndex], parallelPrefixLength);
+  }
+
+  buckets.clear();
+  buckets.shrink_to_fit();
+
+  for (size_t setIndex = 0U; setIndex < numberOfSets; setIndex++) {
     for (size_t coarsePrefixLength = parallelPrefixLength; coarsePrefixLength-- > 0U;) {
       // reduce length of bucket prefixes by 1 by merging tries
       // (e.g., AB, AC, BD, BE: merge AB and AC tries to obtain an A trie, and
       // merge BD and BE tries to obtain a B trie)
-      coarsenBucketTries(bucketPrefixes, bucketTries);
+      coarsenBucketTries(bucketPrefixes[setIndex], bucketTries[setIndex]);
     }
 
-    // bucketTries has size 1 at this point (all tries have merged into one)
-    *this = std::move(bucketTries[0U]);
+    // bucketTries[setIndex] has size 1 at this point (all tries have merged into one)
+    // (only take the root node, as the trie might own the strings)
+    rootNodes[setIndex] = bucketTries[setIndex].empty() ? std::make_unique<Node>()
+        : std::move(bucketTries[setIndex][0U].m_rootNode);
 
     // insert short strings
-    for (const size_t& shortStringIndex : shortStringIndices) {
-      insertString(strings, shortStringIndex);
+    for (const size_t& shortStringIndex : shortStringIndices[setIndex]) {
+      insertStringIntoNode(*rootNodes[setIndex], *stringSets[setIndex], shortStringIndex, 0U);
     }
   }
+
+  return rootNodes;
 }
 
 Trie::Trie(
@@ -62,6 +224,16 @@ Trie::Trie(
   }
 }
 
+Trie::Trie(
+      const StringBuffer& strings,
+      const std::vector<size_t>& stringIndices,
+      size_t ignorePrefixLength)
+      : m_rootNode{std::make_unique<Node>()} {
+  for (const size_t& stringIndex : stringIndices) {
+    insertString(strings, stringIndex, ignorePrefixLength);
+  }
+}
+
 Trie::Trie(
       std::vector<Trie>& tries,
       size_t trieBeginIndex,
@@ -74,6 +246,97 @@ Trie::Trie(
   }
 }
 
+Trie::~Trie() {
+  destroyNode(std::move(m_rootNode));
+}
+
+void Trie::clear() {
+  destroyNode(std::move(m_rootNode));
+  m_rootNode = std::make_unique<Node>();
+  m_strings = StringBuffer{};
+}
+
+std::future<void> Trie::clearInBackground() {
+  // the trie is usable again immediately, while the old nodes are destroyed by another thread
+  // (the returned future blocks on destruction until the old nodes have been destroyed)
+  std::unique_ptr<Node> rootNode{std::move(m_rootNode)};
+  std::unique_ptr<StringBuffer> strings{std::make_unique<StringBuffer>(std::move(m_strings))};
+  m_rootNode = std::make_unique<Node>();
+  m_strings = StringBuffer{};
+
+  return std::async(std::launch::async,
+      [rootNode = std::move(rootNode), strings = std::move(strings)]() mutable {
+        destroyNode(std::move(rootNode));
+        strings.reset();
+      });
+}
+
+size_t Trie::compact() {
+  // shrink the subtrees of the children of the root node in parallel; the released slack is
+  // summed up on the way, so that the trie doesn't have to be measured before and after
+  MemoryUsage rootMemoryUsage;
+  m_rootNode->addOwnMemoryUsage(rootMemoryUsage);
+  size_t numberOfReleasedBytes{rootMemoryUsage.slack};
+  m_rootNode->shrinkChildNodesToFit();
+  const size_t numberOfChildNodes{m_rootNode->getNumberOfChildNodes()};
+
+  #pragma omp parallel for default(none) shared(numberOfChildNodes) \
+      reduction(+: numberOfReleasedBytes) schedule(dynamic)
+  for (size_t childIndex = 0U; childIndex < numberOfChildNodes; childIndex++) {
+    numberOfReleasedBytes += shrinkChildNodesToFit(*m_rootNode->getChildNodeAt(childIndex));
+  }
+
+  const size_t stringsSizeInMemory{m_strings.getHeapSizeInMemory()};
+  m_strings.shrinkToFit();
+  numberOfReleasedBytes += stringsSizeInMemory - m_strings.getHeapSizeInMemory();
+
+  return numberOfReleasedBytes;
+}
+
+size_t Trie::shrinkChildNodesToFit(Node& node) {
+  size_t numberOfReleasedBytes{0U};
+  std::vector<Node*> stack{&node};
+
+  while (!stack.empty()) {
+    Node* currentNode{stack.back()};
+    stack.pop_back();
+    MemoryUsage memoryUsage;
+    currentNode->addOwnMemoryUsage(memoryUsage);
+
+    if (memoryUsage.slack > 0U) {
+      numberOfReleasedBytes += memoryUsage.slack;
+      currentNode->shrinkChildNodesToFit();
+    }
+
+    for (size_t childIndex = 0U; childIndex < currentNode->getNumberOfChildNodes();
+          childIndex++) {
+      if (currentNode->getChildNodeAt(childIndex) != nullptr) {
+        stack.push_back(currentNode->getChildNodeAt(childIndex));
+      }
+    }
+  }
+
+  return numberOfReleasedBytes;
+}
+
+void Trie::destroyNode(std::unique_ptr<Node> node) {
+  if (!node) {
+    return;
+  }
+
+  // destroy the subtrees of the child nodes in parallel (the bucket tries have been
+  // allocated by different threads as well); each subtree is destroyed iteratively
+  std::vector<std::unique_ptr<Node>> childNodes;
+  node->releaseChildNodes(childNodes);
+  const size_t numberOfChildNodes{childNodes.size()};
+
+  #pragma omp parallel for default(none) shared(childNodes, numberOfChildNodes) \
+      if(numberOfChildNodes > 1U) schedule(dynamic)
+  for (size_t childNodeIndex = 0U; childNodeIndex < numberOfChildNodes; childNodeIndex++) {
+    childNodes[childNodeIndex].reset();
+  }
+}
+
 const Node& Trie::getRootNode() const {
   return *m_rootNode;
 }
@@ -82,6 +345,42 @@ Node& Trie::getRootNode() {
   return *m_rootNode;
 }
 
+MemoryUsage Trie::getMemoryUsage(bool measureAllocations) const {
+  MemoryUsage memoryUsage;
+  memoryUsage.payloads = m_strings.getHeapSizeInMemory();
+  m_rootNode->addOwnMemoryUsage(memoryUsage, measureAllocations);
+
+  // traverse the subtrees of the children of the root node in parallel
+  const size_t numberOfChildNodes{m_rootNode->getNumberOfChildNodes()};
+  std::vector<MemoryUsage> childMemoryUsages(numberOfChildNodes);
+
+  #pragma omp parallel for default(none) \
+      shared(numberOfChildNodes, childMemoryUsages, measureAllocations) schedule(dynamic)
+  for (size_t childIndex = 0U; childIndex < numberOfChildNodes; childIndex++) {
+    m_rootNode->getChildNodeAt(childIndex)->addMemoryUsage(
+        childMemoryUsages[childIndex], measureAllocations);
+  }
+
+  for (const MemoryUsage& childMemoryUsage : childMemoryUsages) {
+    memoryUsage += childMemoryUsage;
+  }
+
+  return memoryUsage;
+}
+
+const StringBuffer& Trie::getStrings() const {
+  return m_strings;
+}
+
+std::string Trie::getString(size_t stringIndex) const {
+  if (stringIndex >= m_strings.size()) {
+    throw std::out_of_range("String index " + std::to_string(stringIndex)
+        + " is not in the strings of the trie.");
+  }
+
+  return m_strings.getString(stringIndex);
+}
+
 std::vector<size_t> Trie::searchPrefix(const std::string& prefix) const {
   const Node* descendantNode{m_rootNode->getDescendantNodeForPrefix(prefix)};
   std::vector<size_t> stringIndices;
@@ -93,27 +392,465 @@ std::vector<size_t> Trie::searchPrefix(const std::string& prefix) const {
   return stringIndices;
 }
 
+std::vector<size_t> Trie::searchPrefixShortestFirst(
+      const std::string& prefix,
+      size_t maximumNumberOfMatches) const {
+  return searchShortestFirst<const Node*>(m_rootNode->getDescendantNodeForPrefix(prefix),
+      nullptr, maximumNumberOfMatches,
+      [](const Node* node) {
+        return node->getStringIndex();
+      },
+      [](const Node* node, std::vector<const Node*>& nodes) {
+        for (size_t childIndex = 0U; childIndex < node->getNumberOfChildNodes(); childIndex++) {
+          nodes.push_back(node->getChildNodeAt(childIndex));
+        }
+      });
+}
+
+DeepestPrefixMatches Trie::searchDeepestPrefix(
+      const std::string& prefix,
+      size_t maximumNumberOfMatches) const {
+  // if prefix is not a path in the trie, the matches of the longest prefix of prefix that is a
+  // path are returned instead, so that clients don't have to retry with shorter prefixes
+  DeepestPrefixMatches matches;
+  const Node* descendantNode{
+      m_rootNode->getDeepestDescendantNodeForPrefix(prefix, matches.prefixLength)};
+  descendantNode->collectStringIndices(matches.stringIndices, maximumNumberOfMatches);
+  return matches;
+}
+
+std::vector<size_t> Trie::countPrefixes(const std::vector<std::string>& prefixes) const {
+  const std::vector<const Node*> descendantNodes{descendSortedPrefixes<const Node*>(
+      prefixes, m_rootNode.get(), nullptr,
+      [](const Node* node, unsigned char key) { return node->getChildNode(key); })};
+
+  // the subtrees of the descendant nodes are nested if the prefixes are (e.g., "" and "ab"), so
+  // instead of counting each subtree separately, the union of the subtrees is walked once in
+  // post-order: the subtrees are walked starting with the shortest prefixes, and the counts of
+  // the descendant nodes in a walked subtree are recorded on the way
+  constexpr size_t notCounted = std::numeric_limits<size_t>::max();
+  std::unordered_map<const Node*, size_t> nodeCounts;
+  // only nodes at the depth of one of the prefixes have to be looked up in nodeCounts
+  std::vector<bool> isPrefixLength;
+
+  for (size_t prefixIndex = 0U; prefixIndex < prefixes.size(); prefixIndex++) {
+    if (descendantNodes[prefixIndex] != nullptr) {
+      nodeCounts.emplace(descendantNodes[prefixIndex], notCounted);
+      isPrefixLength.resize(
+          std::max(isPrefixLength.size(), prefixes[prefixIndex].length() + 1U), false);
+      isPrefixLength[prefixes[prefixIndex].length()] = true;
+    }
+  }
+
+  std::vector<size_t> prefixOrder(prefixes.size());
+  std::iota(std::begin(prefixOrder), std::end(prefixOrder), 0U);
+  std::stable_sort(std::begin(prefixOrder), std::end(prefixOrder),
+      [&prefixes](size_t prefixIndex1, size_t prefixIndex2) {
+        return prefixes[prefixIndex1].length() < prefixes[prefixIndex2].length();
+      });
+
+  struct CountFrame {
+    const Node* node;
+    size_t nextChildIndex;
+    size_t numberOfStrings;
+  };
+
+  std::vector<CountFrame> stack;
+
+  for (const size_t& prefixIndex : prefixOrder) {
+    const Node* descendantNode{descendantNodes[prefixIndex]};
+
+    // nested descendant nodes have already been counted in the walk of an enclosing one
+    if ((descendantNode == nullptr) || (nodeCounts[descendantNode] != notCounted)) {
+      continue;
+    }
+
+    const size_t prefixLength{prefixes[prefixIndex].length()};
+    stack.push_back({descendantNode, 0U, 0U});
+
+    while (!stack.empty()) {
+      CountFrame& frame{stack.back()};
+
+      if (frame.nextChildIndex < frame.node->getNumberOfChildNodes()) {
+        const Node* childNode{frame.node->getChildNodeAt(frame.nextChildIndex)};
+        frame.nextChildIndex++;
+
+        if (childNode != nullptr) {
+          stack.push_back({childNode, 0U, 0U});
+        }
+
+        continue;
+      }
+
+      const size_t depth{prefixLength + stack.size() - 1U};
+      const size_t numberOfStrings{frame.numberOfStrings
+          + static_cast<size_t>(frame.node->getStringIndex() != Node::INVALID_STRING_INDEX)};
+
+      if ((depth < isPrefixLength.size()) && isPrefixLength[depth]) {
+        const auto it = nodeCounts.find(frame.node);
+
+        if (it != std::end(nodeCounts)) {
+          it->second = numberOfStrings;
+        }
+      }
+
+      stack.pop_back();
+
+      if (!stack.empty()) {
+        stack.back().numberOfStrings += numberOfStrings;
+      }
+    }
+  }
+
+  std::vector<size_t> counts(prefixes.size(), 0U);
+
+  for (size_t prefixIndex = 0U; prefixIndex < prefixes.size(); prefixIndex++) {
+    if (descendantNodes[prefixIndex] != nullptr) {
+      counts[prefixIndex] = nodeCounts[descendantNodes[prefixIndex]];
+    }
+  }
+
+  return counts;
+}
+
+PrefixSearchResults Trie::searchPrefixesSorted(
+      const std::vector<std::string>& prefixes) const {
+  const std::vector<const Node*> descendantNodes{descendSortedPrefixes<const Node*>(
+      prefixes, m_rootNode.get(), nullptr,
+      [](const Node* node, unsigned char key) { return node->getChildNode(key); })};
+  PrefixSearchResults results;
+  results.offsets.reserve(prefixes.size() + 1U);
+
+  for (const Node* descendantNode : descendantNodes) {
+    if (descendantNode != nullptr) {
+      descendantNode->collectStringIndices(results.stringIndices);
+    }
+
+    results.offsets.push_back(results.stringIndices.size());
+  }
+
+  return results;
+}
+
+FrozenTrie Trie::freeze(size_t rootTableDepth) const {
+  return FrozenTrie{*m_rootNode, rootTableDepth};
+}
+
+void Trie::save(const std::string& path) const {
+  // one section for the root node, one for the subtree of each child of the root node
+  // (i.e., split at the first byte, like the bucketed construction), and one for the strings
+  // if they are owned by the trie
+  const size_t numberOfChildNodes{m_rootNode->getNumberOfChildNodes()};
+  std::vector<TrieFile::SectionType> sectionTypes{TrieFile::SectionType::rootNode};
+  sectionTypes.resize(numberOfChildNodes + 1U, TrieFile::SectionType::subtree);
+  std::vector<std::string> sections(numberOfChildNodes + 1U);
+  TrieFile::encodeRootNode(*m_rootNode, sections[0U]);
+
+  // encode the subtrees in parallel
+  #pragma omp parallel for default(none) shared(numberOfChildNodes, sections) schedule(dynamic)
+  for (size_t childIndex = 0U; childIndex < numberOfChildNodes; childIndex++) {
+    TrieFile::encodeSubtree(*m_rootNode->getChildNodeAt(childIndex), sections[childIndex + 1U]);
+  }
+
+  if (!m_strings.empty()) {
+    sectionTypes.push_back(TrieFile::SectionType::strings);
+    sections.emplace_back();
+    TrieFile::encodeStrings(m_strings, sections.back());
+  }
+
+  TrieFile::write(path, TrieFile::FileType::trie, sectionTypes, sections);
+}
+
+Trie Trie::load(const std::string& path, const std::vector<std::string>& patchPaths) {
+  TrieFile file{path, TrieFile::FileType::trie};
+  std::vector<std::string> sections{file.readAllSections()};
+  const size_t numberOfSections{sections.size()};
+  Trie trie;
+  std::vector<unsigned char> childKeys;
+  std::vector<size_t> subtreeSectionIndices;
+
+  for (size_t sectionIndex = 0U; sectionIndex < numberOfSections; sectionIndex++) {
+    switch (file.getSectionType(sectionIndex)) {
+      case TrieFile::SectionType::rootNode: {
+        trie.m_rootNode = TrieFile::decodeRootNode(sections[sectionIndex], childKeys);
+        break;
+      }
+      case TrieFile::SectionType::subtree: {
+        subtreeSectionIndices.push_back(sectionIndex);
+        break;
+      }
+      case TrieFile::SectionType::strings: {
+        size_t position{0U};
+        trie.m_strings = TrieFile::decodeStrings(sections[sectionIndex], position);
+
+        if (position != sections[sectionIndex].size()) {
+          throw std::runtime_error("Unexpected trailing data in trie file \"" + path + "\".");
+        }
+
+        break;
+      }
+      default: {
+        throw std::runtime_error("Unexpected section in trie file \"" + path + "\".");
+      }
+    }
+  }
+
+  if (subtreeSectionIndices.size() != childKeys.size()) {
+    throw std::runtime_error("Number of subtree sections in trie file \"" + path
+        + "\" does not match number of child nodes.");
+  }
+
+  // decode the subtrees in parallel, releasing the encoded data as soon as it has been decoded
+  const size_t numberOfSubtrees{subtreeSectionIndices.size()};
+  std::vector<std::unique_ptr<Node>> subtrees(numberOfSubtrees);
+  std::string errorMessage;
+
+  #pragma omp parallel for default(none) \
+      shared(numberOfSubtrees, subtrees, sections, subtreeSectionIndices, errorMessage) \
+      schedule(dynamic)
+  for (size_t childIndex = 0U; childIndex < numberOfSubtrees; childIndex++) {
+    std::string& section{sections[subtreeSectionIndices[childIndex]]};
+
+    try {
+      subtrees[childIndex] = TrieFile::decodeSubtree(section);
+    } catch (const std::runtime_error& exception) {
+      // exceptions must not escape the parallel region
+      #pragma omp critical
+      errorMessage = exception.what();
+    }
+
+    std::string{}.swap(section);
+  }
+
+  if (!errorMessage.empty()) {
+    throw std::runtime_error(errorMessage);
+  }
+
+  for (size_t childIndex = 0U; childIndex < numberOfSubtrees; childIndex++) {
+    trie.m_rootNode->appendChildNode(childKeys[childIndex], std::move(subtrees[childIndex]));
+  }
+
+  // the patches are merged into the loaded trie in place (there is no separate delta layer that
+  // would have to be queried next to the trie, as the nodes of the mutable trie can be updated
+  // cheaply anyway)
+  for (const std::string& patchPath : patchPaths) {
+    trie.applyPatch(TriePatch::load(patchPath));
+  }
+
+  return trie;
+}
+
+void Trie::applyPatch(const TriePatch& patch) {
+  const StringBuffer& deletedStrings{patch.getDeletedStrings()};
+  const StringBuffer& insertedStrings{patch.getInsertedStrings()};
+
+  const size_t firstStringIndex{patch.getFirstStringIndex()};
+
+  // the patch is checked before anything is changed, so that a rejected patch leaves the trie
+  // as it was
+  if (insertedStrings.size() > Node::INVALID_STRING_INDEX - firstStringIndex) {
+    throw std::runtime_error("String indices of patch are out of range.");
+  }
+
+  if (!m_strings.empty()) {
+    // the inserted strings have to continue the strings owned by the trie
+    if (firstStringIndex != m_strings.size()) {
+      throw std::runtime_error("Patch does not continue the strings of the trie.");
+    }
+  } else if (!insertedStrings.empty() && containsStringIndexInRange(*m_rootNode,
+        firstStringIndex, firstStringIndex + insertedStrings.size())) {
+    // otherwise, the trie doesn't know its strings, so the inserted strings must at least not
+    // reuse the index of a string in the trie
+    throw std::runtime_error("Patch reuses string indices of the trie.");
+  }
+
+  for (size_t i = 0U; i < deletedStrings.size(); i++) {
+    eraseString(deletedStrings.getString(i));
+  }
+
+  if (!m_strings.empty()) {
+    for (size_t i = 0U; i < insertedStrings.size(); i++) {
+      m_strings.append(insertedStrings.getString(i));
+    }
+  }
+
+  for (size_t i = 0U; i < insertedStrings.size(); i++) {
+    Node* currentNode{m_rootNode.get()};
+
+    for (size_t characterIndex = 0U; characterIndex < insertedStrings.getLength(i);
+          characterIndex++) {
+      const unsigned char byte{static_cast<unsigned char>(
+          insertedStrings.getCharacter(i, characterIndex))};
+      currentNode = &currentNode->getOrCreateChildNode(byte);
+    }
+
+    currentNode->setStringIndex(firstStringIndex + i);
+  }
+}
+
+bool Trie::eraseString(const std::string& string) {
+  std::vector<Node*> path{m_rootNode.get()};
+
+  for (const char& character : string) {
+    Node* childNode{path.back()->getChildNode(static_cast<unsigned char>(character))};
+
+    if (childNode == nullptr) {
+      return false;
+    }
+
+    path.push_back(childNode);
+  }
+
+  if (path.back()->getStringIndex() == Node::INVALID_STRING_INDEX) {
+    return false;
+  }
+
+  path.back()->setStringIndex(Node::INVALID_STRING_INDEX);
+
+  // remove nodes that have become useless (neither a string nor child nodes),
+  // starting from the deepest one
+  for (size_t depth = string.length(); depth > 0U; depth--) {
+    const Node* node{path[depth]};
+
+    if ((node->getStringIndex() != Node::INVALID_STRING_INDEX)
+          || (node->getNumberOfChildNodes() > 0U)) {
+      break;
+    }
+
+    path[depth - 1U]->removeChildNode(static_cast<unsigned char>(string[depth - 1U]));
+  }
+
+  return true;
+}
+
 void Trie::insertString(
       const std::vector<std::string>& strings,
       size_t stringIndex,
       size_t ignorePrefixLength) {
-  Node* currentNode{m_rootNode.get()};
+  insertStringInternal(strings, stringIndex, ignorePrefixLength);
+}
+
+void Trie::insertString(
+      const StringBuffer& strings,
+      size_t stringIndex,
+      size_t ignorePrefixLength) {
+  insertStringInternal(strings, stringIndex, ignorePrefixLength);
+}
+
+template <typename Strings>
+void Trie::insertStringInternal(
+      const Strings& strings,
+      size_t stringIndex,
+      size_t ignorePrefixLength) {
+  insertStringIntoNode(*m_rootNode, strings, stringIndex, ignorePrefixLength);
+}
 
-  for (size_t characterIndex = ignorePrefixLength; characterIndex < strings[stringIndex].size();
-        characterIndex++) {
-    const unsigned char byte{static_cast<unsigned char>(strings[stringIndex][characterIndex])};
+template <typename Strings>
+void Trie::insertStringIntoNode(
+      Node& node,
+      const Strings& strings,
+      size_t stringIndex,
+      size_t ignorePrefixLength) {
+  Node* currentNode{&node};
+  const size_t length{getStringLength(strings, stringIndex)};
+
+  for (size_t characterIndex = ignorePrefixLength; characterIndex < length; characterIndex++) {
+    const unsigned char byte{static_cast<unsigned char>(
+        getStringCharacter(strings, stringIndex, characterIndex))};
     currentNode = &currentNode->getOrCreateChildNode(byte);
   }
 
   currentNode->setStringIndex(stringIndex);
 }
 
+void Trie::insertBatch(
+      const std::vector<std::string>& strings,
+      const std::vector<size_t>& stringIndices,
+      size_t parallelPrefixLength) {
+  insertBatchInternal(strings, stringIndices, parallelPrefixLength);
+}
+
+void Trie::insertBatch(
+      const StringBuffer& strings,
+      const std::vector<size_t>& stringIndices,
+      size_t parallelPrefixLength) {
+  insertBatchInternal(strings, stringIndices, parallelPrefixLength);
+}
+
+template <typename Strings>
+void Trie::insertBatchInternal(
+      const Strings& strings,
+      const std::vector<size_t>& stringIndices,
+      size_t parallelPrefixLength) {
+  if ((parallelPrefixLength == 0U) || (omp_get_max_threads() == 1)) {
+    for (const size_t& stringIndex : stringIndices) {
+      insertStringInternal(strings, stringIndex, 0U);
+    }
+
+    return;
+  }
+
+  std::vector<std::string> bucketPrefixes;
+  std::vector<std::vector<size_t>> buckets;
+  std::vector<size_t> shortStringIndices;
+  bucketSortStringsInternal(strings, &stringIndices, parallelPrefixLength, bucketPrefixes,
+      buckets, shortStringIndices);
+
+  // find or create the node for each bucket prefix; the subtrees of these nodes are disjoint,
+  // so each bucket can be inserted into its subtree without locking
+  std::vector<Node*> bucketNodes(buckets.size());
+
+  for (size_t bucketIndex = 0U; bucketIndex < buckets.size(); bucketIndex++) {
+    Node* bucketNode{m_rootNode.get()};
+
+    for (const char& character : bucketPrefixes[bucketIndex]) {
+      bucketNode = &bucketNode->getOrCreateChildNode(static_cast<unsigned char>(character));
+    }
+
+    bucketNodes[bucketIndex] = bucketNode;
+  }
+
+  #pragma omp parallel for default(none) \
+      shared(strings, parallelPrefixLength, buckets, bucketNodes) schedule(dynamic)
+  for (size_t bucketIndex = 0U; bucketIndex < buckets.size(); bucketIndex++) {
+    for (const size_t& stringIndex : buckets[bucketIndex]) {
+      insertStringIntoNode(*bucketNodes[bucketIndex], strings, stringIndex, parallelPrefixLength);
+    }
+  }
+
+  for (const size_t& shortStringIndex : shortStringIndices) {
+    insertStringInternal(strings, shortStringIndex, 0U);
+  }
+}
+
 void Trie::bucketSortStrings(
       const std::vector<std::string>& strings,
       size_t prefixLength,
       std::vector<std::string>& bucketPrefixes,
       std::vector<std::vector<size_t>>& buckets,
       std::vector<size_t> &shortStringIndices) {
+  bucketSortStringsInternal(
+      strings, nullptr, prefixLength, bucketPrefixes, buckets, shortStringIndices);
+}
+
+void Trie::bucketSortStrings(
+      const StringBuffer& strings,
+      size_t prefixLength,
+      std::vector<std::string>& bucketPrefixes,
+      std::vector<std::vector<size_t>>& buckets,
+      std::vector<size_t> &shortStringIndices) {
+  bucketSortStringsInternal(
+      strings, nullptr, prefixLength, bucketPrefixes, buckets, shortStringIndices);
+}
+
+template <typename Strings>
+void Trie::bucketSortStringsInternal(
+      const Strings& strings,
+      const std::vector<size_t>* stringIndices,
+      size_t prefixLength,
+      std::vector<std::string>& bucketPrefixes,
+      std::vector<std::vector<size_t>>& buckets,
+      std::vector<size_t> &shortStringIndices) {
   bucketPrefixes.clear();
   buckets.clear();
   shortStringIndices.clear();
@@ -132,15 +869,21 @@ void Trie::bucketSortStrings(
 
   // currentPowerOf256 is 256 ** prefixLength at this point
   std::vector<std::vector<size_t>> allBucketVectors(currentPowerOf256);
+  // sort only the given strings, or all strings if stringIndices is nullptr
+  const size_t numberOfStrings{
+      (stringIndices != nullptr) ? stringIndices->size() : getNumberOfStrings(strings)};
+
+  for (size_t i = 0U; i < numberOfStrings; i++) {
+    const size_t stringIndex{(stringIndices != nullptr) ? (*stringIndices)[i] : i};
 
-  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
-    if (strings[stringIndex].length() >= prefixLength) {
+    if (getStringLength(strings, stringIndex) >= prefixLength) {
       // store indices of long strings in bucket corresponding to its prefix
       // bucket indices are in lexicographical order (e.g., AA, AB, BA, BB --> 0, 1, 2, 3)
       size_t bucketIndex = 0U;
 
-      for (size_t i = 0U; i < prefixLength; i++) {
-        bucketIndex += static_cast<unsigned char>(strings[stringIndex][i]) * powersOf256[i];
+      for (size_t characterIndex = 0U; characterIndex < prefixLength; characterIndex++) {
+        bucketIndex += static_cast<unsigned char>(
+            getStringCharacter(strings, stringIndex, characterIndex)) * powersOf256[characterIndex];
       }
 
       allBucketVectors[bucketIndex].push_back(stringIndex);
@@ -161,7 +904,8 @@ void Trie::bucketSortStrings(
       }
 
       bucketPrefixes.push_back(currentPrefix);
-      buckets.push_back(allBucketVectors[bucketIndex]);
+      // move instead of copy, so that the bucket indices are not stored twice
+      buckets.push_back(std::move(allBucketVectors[bucketIndex]));
     }
   }
 }
@@ -170,6 +914,21 @@ std::vector<Trie> Trie::createBucketTries(
       const std::vector<std::string>& strings,
       const size_t prefixLength,
       const std::vector<std::vector<size_t>>& buckets) {
+  return createBucketTriesInternal(strings, prefixLength, buckets);
+}
+
+std::vector<Trie> Trie::createBucketTries(
+      const StringBuffer& strings,
+      const size_t prefixLength,
+      const std::vector<std::vector<size_t>>& buckets) {
+  return createBucketTriesInternal(strings, prefixLength, buckets);
+}
+
+template <typename Strings>
+std::vector<Trie> Trie::createBucketTriesInternal(
+      const Strings& strings,
+      const size_t prefixLength,
+      const std::vector<std::vector<size_t>>& buckets) {
   std::vector<Trie> bucketTries(buckets.size());
 
   // create one trie for each bucket, ignoring the first prefixLength characters in each string
@@ -8,13 +8,19 @@
 #ifndef TRIE_TRIE_HPP
 #define TRIE_TRIE_HPP
 
+#include <future>
 #include <limits>
 #include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "trie/FrozenTrie.hpp"
+#include "trie/MemoryUsage.hpp"
 #include "trie/Node.hpp"
+#include "trie/PrefixDescent.hpp"
+#include "trie/StringBuffer.hpp"
+#include "trie/TriePatch.hpp"
 
 namespace trie {
 
@@ -22,24 +28,77 @@ class Trie {
   public:
     Trie();
     explicit Trie(const std::vector<std::string>& strings, size_t parallelPrefixLength = 2U);
+    explicit Trie(std::vector<std::string>&& strings, size_t parallelPrefixLength = 2U);
     Trie(
         const std::vector<std::string>& strings,
         const std::vector<size_t>& stringIndices,
         size_t ignorePrefixLength = 0U);
+    Trie(
+        const StringBuffer& strings,
+        const std::vector<size_t>& stringIndices,
+        size_t ignorePrefixLength = 0U);
     Trie(
         std::vector<Trie>& tries,
         size_t trieBeginIndex,
         const std::vector<unsigned char>& keys);
+    Trie(const Trie&) = delete;
+    Trie(Trie&&) = default;
+    Trie& operator=(const Trie&) = delete;
+    Trie& operator=(Trie&&) = default;
+    ~Trie();
+
+    void clear();
+    // releases the unused capacity of the child node arrays and of the owned strings, and
+    // returns the number of released bytes; this is only the slack left by the construction
+    // (about 0.5% of the memory of the benchmark trie), while the node headers and the
+    // allocator overhead stay the same
+    size_t compact();
+    std::future<void> clearInBackground();
 
     const Node& getRootNode() const;
     Node& getRootNode();
 
+    MemoryUsage getMemoryUsage(bool measureAllocations = false) const;
+
+    const StringBuffer& getStrings() const;
+    // only supported by tries that own their strings (i.e., whose getStrings() isn't empty);
+    // throws std::out_of_range if the string index is not in getStrings()
+    std::string getString(size_t stringIndex) const;
+
     std::vector<size_t> searchPrefix(const std::string& prefix) const;
+    std::vector<size_t> searchPrefixShortestFirst(
+        const std::string& prefix,
+        size_t maximumNumberOfMatches = std::numeric_limits<size_t>::max()) const;
+    DeepestPrefixMatches searchDeepestPrefix(
+        const std::string& prefix,
+        size_t maximumNumberOfMatches = std::numeric_limits<size_t>::max()) const;
+    std::vector<size_t> countPrefixes(const std::vector<std::string>& prefixes) const;
+    PrefixSearchResults searchPrefixesSorted(const std::vector<std::string>& prefixes) const;
+
+    FrozenTrie freeze(size_t rootTableDepth = FrozenTrie::DEFAULT_ROOT_TABLE_DEPTH) const;
+
+    void save(const std::string& path) const;
+    static Trie load(const std::string& path, const std::vector<std::string>& patchPaths = {});
+    void applyPatch(const TriePatch& patch);
+    bool eraseString(const std::string& string);
 
     void insertString(
         const std::vector<std::string>& strings,
         size_t stringIndex,
         size_t ignorePrefixLength = 0U);
+    void insertString(
+        const StringBuffer& strings,
+        size_t stringIndex,
+        size_t ignorePrefixLength = 0U);
+
+    void insertBatch(
+        const std::vector<std::string>& strings,
+        const std::vector<size_t>& stringIndices,
+        size_t parallelPrefixLength = 2U);
+    void insertBatch(
+        const StringBuffer& strings,
+        const std::vector<size_t>& stringIndices,
+        size_t parallelPrefixLength = 2U);
 
     static void bucketSortStrings(
         const std::vector<std::string>& strings,
@@ -47,20 +106,85 @@ class Trie {
         std::vector<std::string>& bucketPrefixes,
         std::vector<std::vector<size_t>>& buckets,
         std::vector<size_t> &shortStringIndices);
+    static void bucketSortStrings(
+        const StringBuffer& strings,
+        size_t prefixLength,
+        std::vector<std::string>& bucketPrefixes,
+        std::vector<std::vector<size_t>>& buckets,
+        std::vector<size_t> &shortStringIndices);
 
     static std::vector<Trie> createBucketTries(
         const std::vector<std::string>& strings,
         size_t prefixLength,
         const std::vector<std::vector<size_t>>& buckets);
+    static std::vector<Trie> createBucketTries(
+        const StringBuffer& strings,
+        size_t prefixLength,
+        const std::vector<std::vector<size_t>>& buckets);
+
+    // creates one trie for each of the sets of strings, using one parallel pass for all sets
+    static std::vector<Trie> createTries(
+        const std::vector<const std::vector<std::string>*>& stringSets,
+        size_t parallelPrefixLength = 2U);
 
     static void coarsenBucketTries(
         std::vector<std::string>& bucketPrefixes,
         std::vector<Trie>& bucketTries);
 
   private:
+    static void destroyNode(std::unique_ptr<Node> node);
+    static size_t shrinkChildNodesToFit(Node& node);
+
+    template <typename Strings>
+    void constructFromStrings(const Strings& strings, size_t parallelPrefixLength);
+
+    template <typename Strings>
+    static std::vector<std::unique_ptr<Node>> createRootNodes(
+        const std::vector<const Strings*>& stringSets,
+        size_t parallelPrefixLength);
+
+    template <typename Strings>
+    void insertStringInternal(
+        const Strings& strings,
+        size_t stringIndex,
+        size_t ignorePrefixLength);
+
+    template <typename Strings>
+    static void insertStringIntoNode(
+        Node& node,
+        const Strings& strings,
+        size_t stringIndex,
+        size_t ignorePrefixLength);
+
+    template <typename Strings>
+    void insertBatchInternal(
+        const Strings& strings,
+        const std::vector<size_t>& stringIndices,
+        size_t parallelPrefixLength);
+
+    template <typename Strings>
+    static void bucketSortStringsInternal(
+        const Strings& strings,
+        const std::vector<size_t>* stringIndices,
+        size_t prefixLength,
+        std::vector<std::string>& bucketPrefixes,
+        std::vector<std::vector<size_t>>& buckets,
+        std::vector<size_t> &shortStringIndices);
+
+    template <typename Strings>
+    static std::vector<Trie> createBucketTriesInternal(
+        const Strings& strings,
+        size_t prefixLength,
+        const std::vector<std::vector<size_t>>& buckets);
+
     std::unique_ptr<Node> m_rootNode;
+    // only non-empty if the trie has been constructed by consuming the input strings
+    StringBuffer m_strings;
 };
 
+// mutable trie that is used to build a FrozenTrie
+using TrieBuilder = Trie;
+
 }  // namespace trie
 
 #endif  // #ifndef TRIE_TRIE_HPP
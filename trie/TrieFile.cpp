@@ -0,0 +1,439 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trie/Checksum.hpp"
+#include "trie/Node.hpp"
+#include "trie/StringBuffer.hpp"
+#include "trie/TrieFile.hpp"
+
+namespace trie {
+
+namespace {
+
+constexpr size_t magicLength = 8U;
+constexpr std::uint32_t numberOfBitsPerByte = 8U;
+constexpr std::uint64_t byteMask = 0xFFU;
+constexpr std::uint64_t varintPayloadMask = 0x7FU;
+constexpr std::uint64_t varintContinuationBit = 0x80U;
+constexpr std::uint32_t numberOfVarintPayloadBits = 7U;
+constexpr std::uint32_t maximumNumberOfSections = 1U << 20U;
+constexpr size_t maximumNumberOfChildNodes = 256U;
+
+// size of type, checksum, offset, and size of a section in the section table
+constexpr size_t sectionTableEntrySize = 4U + 4U + 8U + 8U;
+// size of magic, version, and number of sections
+constexpr size_t headerPrefixSize = magicLength + 4U + 4U;
+
+std::string getMagic(TrieFile::FileType fileType) {
+  // pad to magicLength with null characters
+  switch (fileType) {
+    case TrieFile::FileType::trie: {
+      return std::string{"PSTRIE\0\0", magicLength};
+    }
+    case TrieFile::FileType::patch: {
+      return std::string{"PSPATCH\0", magicLength};
+    }
+    case TrieFile::FileType::frozenTrie: {
+      return std::string{"PSFROZEN", magicLength};
+    }
+  }
+
+  throw std::invalid_argument("Unknown trie file type.");
+}
+
+unsigned char readByte(const std::string& bytes, size_t& position) {
+  if (position >= bytes.size()) {
+    throw std::runtime_error("Unexpected end of data while reading trie file.");
+  }
+
+  return static_cast<unsigned char>(bytes[position++]);
+}
+
+std::string readFromStream(std::ifstream& stream, const std::string& path, size_t size) {
+  std::string bytes(size, '\0');
+
+  if (!stream.read(&bytes[0U], static_cast<std::streamsize>(size))) {
+    throw std::runtime_error("Could not read from trie file \"" + path + "\".");
+  }
+
+  return bytes;
+}
+
+// string indices are stored incremented by one, so that INVALID_STRING_INDEX is stored as 0
+std::uint64_t encodeStringIndex(size_t stringIndex) {
+  return (stringIndex == Node::INVALID_STRING_INDEX) ? 0U : (stringIndex + 1U);
+}
+
+size_t decodeStringIndex(std::uint64_t encodedStringIndex) {
+  return (encodedStringIndex == 0U) ? Node::INVALID_STRING_INDEX : (encodedStringIndex - 1U);
+}
+
+void encodeNodeHeader(const Node& node, std::string& bytes) {
+  TrieFile::appendVarint(encodeStringIndex(node.getStringIndex()), bytes);
+  TrieFile::appendVarint(node.getNumberOfChildNodes(), bytes);
+}
+
+std::unique_ptr<Node> decodeNodeHeader(
+      const std::string& bytes,
+      size_t& position,
+      size_t& numberOfChildNodes) {
+  std::unique_ptr<Node> node{std::make_unique<Node>()};
+  node->setStringIndex(decodeStringIndex(TrieFile::readVarint(bytes, position)));
+  numberOfChildNodes = TrieFile::readVarint(bytes, position);
+
+  if (numberOfChildNodes > maximumNumberOfChildNodes) {
+    throw std::runtime_error("Invalid number of child nodes in trie file.");
+  }
+
+  node->reserveChildNodes(numberOfChildNodes);
+  return node;
+}
+
+}  // namespace
+
+TrieFile::TrieFile(const std::string& path, FileType fileType)
+      : m_path{path}, m_stream{path, std::ios::binary} {
+  if (!m_stream) {
+    throw std::runtime_error("Could not open trie file \"" + path + "\".");
+  }
+
+  std::string header{readFromStream(m_stream, m_path, headerPrefixSize)};
+
+  if (header.compare(0U, magicLength, getMagic(fileType)) != 0) {
+    throw std::runtime_error("File \"" + path + "\" is not a trie file of the expected type.");
+  }
+
+  size_t position{magicLength};
+  const std::uint64_t version{readFixed(header, position, 4U)};
+
+  if (version != VERSION) {
+    throw std::runtime_error("Unsupported version " + std::to_string(version)
+        + " of trie file \"" + path + "\".");
+  }
+
+  const std::uint64_t numberOfSections{readFixed(header, position, 4U)};
+
+  if (numberOfSections > maximumNumberOfSections) {
+    throw std::runtime_error("Corrupt header of trie file \"" + path + "\".");
+  }
+
+  header += readFromStream(m_stream, m_path, numberOfSections * sectionTableEntrySize);
+  std::string headerChecksum{readFromStream(m_stream, m_path, 4U)};
+  size_t headerChecksumPosition{0U};
+
+  if (Checksum::computeCrc32(header) != readFixed(headerChecksum, headerChecksumPosition, 4U)) {
+    throw std::runtime_error("Checksum mismatch in header of trie file \"" + path + "\".");
+  }
+
+  m_stream.seekg(0, std::ios::end);
+  m_fileSize = static_cast<std::uint64_t>(m_stream.tellg());
+
+  for (size_t sectionIndex = 0U; sectionIndex < numberOfSections; sectionIndex++) {
+    SectionInfo sectionInfo{};
+    sectionInfo.type = static_cast<SectionType>(readFixed(header, position, 4U));
+    sectionInfo.checksum = static_cast<std::uint32_t>(readFixed(header, position, 4U));
+    sectionInfo.offset = readFixed(header, position, 8U);
+    sectionInfo.size = readFixed(header, position, 8U);
+    m_sectionInfos.push_back(sectionInfo);
+  }
+}
+
+size_t TrieFile::getNumberOfSections() const {
+  return m_sectionInfos.size();
+}
+
+TrieFile::SectionType TrieFile::getSectionType(size_t sectionIndex) const {
+  return m_sectionInfos[sectionIndex].type;
+}
+
+std::vector<std::string> TrieFile::readAllSections() {
+  // read each section directly into its own buffer (TrieFile::write stores the sections
+  // contiguously and in order, so this is one sequential pass over the file, and the data isn't
+  // copied again afterwards), then verify the checksums of all sections in parallel
+  const size_t numberOfSections{m_sectionInfos.size()};
+  std::vector<std::string> sections(numberOfSections);
+  bool checksumsMatch{true};
+
+  for (size_t sectionIndex = 0U; sectionIndex < numberOfSections; sectionIndex++) {
+    const SectionInfo& sectionInfo{m_sectionInfos[sectionIndex]};
+
+    // sections that exceed the end of the file can only be contained in corrupt files
+    if (!isInFile(sectionInfo)) {
+      checksumsMatch = false;
+      break;
+    }
+
+    m_stream.seekg(static_cast<std::streamoff>(sectionInfo.offset));
+    sections[sectionIndex] = readFromStream(m_stream, m_path, sectionInfo.size);
+  }
+
+  if (checksumsMatch) {
+    #pragma omp parallel for default(none) shared(sections, numberOfSections) \
+        reduction(&&: checksumsMatch) schedule(dynamic)
+    for (size_t sectionIndex = 0U; sectionIndex < numberOfSections; sectionIndex++) {
+      if (Checksum::computeCrc32(sections[sectionIndex])
+            != m_sectionInfos[sectionIndex].checksum) {
+        checksumsMatch = false;
+      }
+    }
+  }
+
+  if (!checksumsMatch) {
+    throw std::runtime_error("Checksum mismatch in trie file \"" + m_path + "\".");
+  }
+
+  return sections;
+}
+
+bool TrieFile::isInFile(const SectionInfo& sectionInfo) const {
+  return (sectionInfo.offset <= m_fileSize)
+      && (sectionInfo.size <= m_fileSize - sectionInfo.offset);
+}
+
+void TrieFile::write(
+      const std::string& path,
+      FileType fileType,
+      const std::vector<SectionType>& sectionTypes,
+      const std::vector<std::string>& sections) {
+  std::string header{getMagic(fileType)};
+  appendFixed(VERSION, 4U, header);
+  appendFixed(sections.size(), 4U, header);
+
+  std::uint64_t offset{headerPrefixSize + sections.size() * sectionTableEntrySize + 4U};
+  const size_t numberOfSections{sections.size()};
+  std::vector<std::uint32_t> checksums(numberOfSections);
+
+  #pragma omp parallel for default(none) shared(sections, numberOfSections, checksums) \
+      schedule(dynamic)
+  for (size_t sectionIndex = 0U; sectionIndex < numberOfSections; sectionIndex++) {
+    checksums[sectionIndex] = Checksum::computeCrc32(sections[sectionIndex]);
+  }
+
+  for (size_t sectionIndex = 0U; sectionIndex < sections.size(); sectionIndex++) {
+    appendFixed(static_cast<std::uint32_t>(sectionTypes[sectionIndex]), 4U, header);
+    appendFixed(checksums[sectionIndex], 4U, header);
+    appendFixed(offset, 8U, header);
+    appendFixed(sections[sectionIndex].size(), 8U, header);
+    offset += sections[sectionIndex].size();
+  }
+
+  appendFixed(Checksum::computeCrc32(header), 4U, header);
+
+  // each section is written with one large sequential write
+  std::ofstream stream{path, std::ios::binary | std::ios::trunc};
+  stream.write(header.data(), static_cast<std::streamsize>(header.size()));
+
+  for (const std::string& section : sections) {
+    stream.write(section.data(), static_cast<std::streamsize>(section.size()));
+  }
+
+  if (!stream) {
+    throw std::runtime_error("Could not write trie file \"" + path + "\".");
+  }
+}
+
+void TrieFile::encodeRootNode(const Node& rootNode, std::string& bytes) {
+  encodeNodeHeader(rootNode, bytes);
+
+  for (size_t childIndex = 0U; childIndex < rootNode.getNumberOfChildNodes(); childIndex++) {
+    bytes.push_back(static_cast<char>(rootNode.getChildKeyAt(childIndex)));
+  }
+}
+
+std::unique_ptr<Node> TrieFile::decodeRootNode(
+      const std::string& bytes,
+      std::vector<unsigned char>& childKeys) {
+  size_t position{0U};
+  size_t numberOfChildNodes{0U};
+  std::unique_ptr<Node> rootNode{decodeNodeHeader(bytes, position, numberOfChildNodes)};
+  childKeys.clear();
+
+  for (size_t childIndex = 0U; childIndex < numberOfChildNodes; childIndex++) {
+    childKeys.push_back(readByte(bytes, position));
+  }
+
+  if (position != bytes.size()) {
+    throw std::runtime_error("Unexpected trailing data in trie file section.");
+  }
+
+  return rootNode;
+}
+
+void TrieFile::encodeSubtree(const Node& node, std::string& bytes) {
+  // nodes are stored in preorder, each node (except the first) preceded by its key
+  encodeNodeHeader(node, bytes);
+  std::vector<std::pair<const Node*, size_t>> stack{{&node, 0U}};
+
+  while (!stack.empty()) {
+    const Node* currentNode{stack.back().first};
+    const size_t childIndex{stack.back().second};
+
+    if (childIndex == currentNode->getNumberOfChildNodes()) {
+      stack.pop_back();
+      continue;
+    }
+
+    stack.back().second++;
+    const Node* childNode{currentNode->getChildNodeAt(childIndex)};
+    bytes.push_back(static_cast<char>(currentNode->getChildKeyAt(childIndex)));
+    encodeNodeHeader(*childNode, bytes);
+    stack.emplace_back(childNode, 0U);
+  }
+}
+
+std::unique_ptr<Node> TrieFile::decodeSubtree(const std::string& bytes) {
+  size_t position{0U};
+  size_t numberOfChildNodes{0U};
+  std::unique_ptr<Node> node{decodeNodeHeader(bytes, position, numberOfChildNodes)};
+  // pairs of node and number of its child nodes that still have to be decoded
+  std::vector<std::pair<Node*, size_t>> stack{{node.get(), numberOfChildNodes}};
+
+  while (!stack.empty()) {
+    if (stack.back().second == 0U) {
+      stack.pop_back();
+      continue;
+    }
+
+    stack.back().second--;
+    Node* parentNode{stack.back().first};
+    const unsigned char key{readByte(bytes, position)};
+    std::unique_ptr<Node> childNode{decodeNodeHeader(bytes, position, numberOfChildNodes)};
+    stack.emplace_back(childNode.get(), numberOfChildNodes);
+    parentNode->appendChildNode(key, std::move(childNode));
+  }
+
+  if (position != bytes.size()) {
+    throw std::runtime_error("Unexpected trailing data in trie file section.");
+  }
+
+  return node;
+}
+
+void TrieFile::encodeStrings(const StringBuffer& strings, std::string& bytes) {
+  appendVarint(strings.size(), bytes);
+
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+    appendVarint(strings.getLength(stringIndex), bytes);
+  }
+
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+    bytes.append(strings.getString(stringIndex));
+  }
+}
+
+StringBuffer TrieFile::decodeStrings(const std::string& bytes, size_t& position) {
+  const size_t numberOfStrings{readVarint(bytes, position)};
+
+  // each length takes at least one byte, so corrupt counts are rejected before allocating
+  if (numberOfStrings > bytes.size() - position) {
+    throw std::runtime_error("Unexpected end of data while reading trie file.");
+  }
+
+  std::vector<size_t> lengths;
+  lengths.reserve(numberOfStrings);
+  size_t numberOfCharacters{0U};
+
+  for (size_t stringIndex = 0U; stringIndex < numberOfStrings; stringIndex++) {
+    lengths.push_back(readVarint(bytes, position));
+
+    // the characters follow the lengths, so the sum of the lengths can't exceed the remaining
+    // bytes (checked while summing, so that the sum can't overflow)
+    const size_t remainingSize{bytes.size() - position};
+
+    if ((numberOfCharacters > remainingSize)
+          || (lengths.back() > remainingSize - numberOfCharacters)) {
+      throw std::runtime_error("Unexpected end of data while reading trie file.");
+    }
+
+    numberOfCharacters += lengths.back();
+  }
+
+  StringBuffer strings;
+  strings.reserve(numberOfStrings, numberOfCharacters);
+
+  for (const size_t& length : lengths) {
+    strings.append(bytes, position, length);
+    position += length;
+  }
+
+  return strings;
+}
+
+void TrieFile::appendFixed(std::uint64_t value, size_t numberOfBytes, std::string& bytes) {
+  // little endian, independent of the byte order of the host
+  if (IS_LITTLE_ENDIAN_HOST) {
+    bytes.append(reinterpret_cast<const char*>(&value), numberOfBytes);
+    return;
+  }
+
+  for (size_t i = 0U; i < numberOfBytes; i++) {
+    bytes.push_back(static_cast<char>((value >> (i * numberOfBitsPerByte)) & byteMask));
+  }
+}
+
+std::uint64_t TrieFile::readFixed(
+      const std::string& bytes,
+      size_t& position,
+      size_t numberOfBytes) {
+  if (position + numberOfBytes > bytes.size()) {
+    throw std::runtime_error("Unexpected end of data while reading trie file.");
+  }
+
+  std::uint64_t value{0U};
+
+  if (IS_LITTLE_ENDIAN_HOST) {
+    std::memcpy(&value, &bytes[position], numberOfBytes);
+  } else {
+    for (size_t i = 0U; i < numberOfBytes; i++) {
+      value |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[position + i]))
+          << (i * numberOfBitsPerByte);
+    }
+  }
+
+  position += numberOfBytes;
+  return value;
+}
+
+void TrieFile::appendVarint(std::uint64_t value, std::string& bytes) {
+  // LEB128: 7 bits per byte, most significant bit is set if more bytes follow
+  while (value > varintPayloadMask) {
+    bytes.push_back(static_cast<char>((value & varintPayloadMask) | varintContinuationBit));
+    value >>= numberOfVarintPayloadBits;
+  }
+
+  bytes.push_back(static_cast<char>(value));
+}
+
+std::uint64_t TrieFile::readVarint(const std::string& bytes, size_t& position) {
+  std::uint64_t value{0U};
+  std::uint32_t shift{0U};
+  constexpr std::uint32_t maximumShift = 64U;
+
+  while (shift < maximumShift) {
+    const std::uint64_t byte{readByte(bytes, position)};
+    value |= (byte & varintPayloadMask) << shift;
+
+    if ((byte & varintContinuationBit) == 0U) {
+      return value;
+    }
+
+    shift += numberOfVarintPayloadBits;
+  }
+
+  throw std::runtime_error("Invalid variable-length integer in trie file.");
+}
+
+}  // namespace trie
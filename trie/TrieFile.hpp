@@ -0,0 +1,159 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_TRIEFILE_HPP
+#define TRIE_TRIEFILE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "trie/Node.hpp"
+#include "trie/StringBuffer.hpp"
+
+namespace trie {
+
+// On-disk container for tries and patches. The file starts with a header consisting of a magic
+// string, the format version, and a table of sections (type, CRC-32, offset, size), followed by
+// a CRC-32 of the header itself. The header is verified when opening the file; the checksums of
+// the sections are verified when all sections are read with readAllSections.
+class TrieFile {
+  public:
+    enum class FileType {
+      trie,
+      patch,
+      frozenTrie,
+    };
+
+    enum class SectionType : std::uint32_t {
+      rootNode = 1U,
+      subtree = 2U,
+      strings = 3U,
+      insertedStrings = 4U,
+      deletedStrings = 5U,
+      frozenNodes = 6U,
+      childKeys = 7U,
+      childNodeIndices = 8U,
+      stringIndices = 9U,
+    };
+
+    // version 2 removed the number of child nodes from the node records of frozen tries
+    static constexpr std::uint32_t VERSION = 2U;
+
+    TrieFile(const std::string& path, FileType fileType);
+
+    size_t getNumberOfSections() const;
+    SectionType getSectionType(size_t sectionIndex) const;
+    std::vector<std::string> readAllSections();
+
+    static void write(
+        const std::string& path,
+        FileType fileType,
+        const std::vector<SectionType>& sectionTypes,
+        const std::vector<std::string>& sections);
+
+    static void encodeRootNode(const Node& rootNode, std::string& bytes);
+    static std::unique_ptr<Node> decodeRootNode(
+        const std::string& bytes,
+        std::vector<unsigned char>& childKeys);
+
+    static void encodeSubtree(const Node& node, std::string& bytes);
+    static std::unique_ptr<Node> decodeSubtree(const std::string& bytes);
+
+    static void encodeStrings(const StringBuffer& strings, std::string& bytes);
+    static StringBuffer decodeStrings(const std::string& bytes, size_t& position);
+
+    static void appendFixed(std::uint64_t value, size_t numberOfBytes, std::string& bytes);
+    static std::uint64_t readFixed(
+        const std::string& bytes,
+        size_t& position,
+        size_t numberOfBytes);
+    // arrays of unsigned integers are copied in bulk if their representation in memory equals
+    // the one in the file (little endian with numberOfBytes bytes per value)
+    template <typename T>
+    static void appendFixedArray(
+        const T* values,
+        size_t numberOfValues,
+        size_t numberOfBytes,
+        std::string& bytes);
+    template <typename T>
+    static void readFixedArray(
+        const std::string& bytes,
+        size_t& position,
+        size_t numberOfBytes,
+        T* values,
+        size_t numberOfValues);
+    static void appendVarint(std::uint64_t value, std::string& bytes);
+    static std::uint64_t readVarint(const std::string& bytes, size_t& position);
+
+  private:
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+    static constexpr bool IS_LITTLE_ENDIAN_HOST = true;
+#else
+    static constexpr bool IS_LITTLE_ENDIAN_HOST = false;
+#endif
+
+    struct SectionInfo {
+      SectionType type;
+      std::uint32_t checksum;
+      std::uint64_t offset;
+      std::uint64_t size;
+    };
+
+    bool isInFile(const SectionInfo& sectionInfo) const;
+
+    std::string m_path;
+    std::ifstream m_stream;
+    std::vector<SectionInfo> m_sectionInfos;
+    std::uint64_t m_fileSize{0U};
+};
+
+template <typename T>
+void TrieFile::appendFixedArray(
+      const T* values,
+      size_t numberOfValues,
+      size_t numberOfBytes,
+      std::string& bytes) {
+  if (IS_LITTLE_ENDIAN_HOST && (sizeof(T) == numberOfBytes)) {
+    bytes.append(reinterpret_cast<const char*>(values), numberOfValues * numberOfBytes);
+    return;
+  }
+
+  for (size_t valueIndex = 0U; valueIndex < numberOfValues; valueIndex++) {
+    appendFixed(values[valueIndex], numberOfBytes, bytes);
+  }
+}
+
+template <typename T>
+void TrieFile::readFixedArray(
+      const std::string& bytes,
+      size_t& position,
+      size_t numberOfBytes,
+      T* values,
+      size_t numberOfValues) {
+  if (IS_LITTLE_ENDIAN_HOST && (sizeof(T) == numberOfBytes)) {
+    if ((position > bytes.size()) || (numberOfValues > (bytes.size() - position) / numberOfBytes)) {
+      throw std::runtime_error("Unexpected end of data while reading trie file.");
+    }
+
+    std::memcpy(values, &bytes[position], numberOfValues * numberOfBytes);
+    position += numberOfValues * numberOfBytes;
+    return;
+  }
+
+  for (size_t valueIndex = 0U; valueIndex < numberOfValues; valueIndex++) {
+    values[valueIndex] = static_cast<T>(readFixed(bytes, position, numberOfBytes));
+  }
+}
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_TRIEFILE_HPP
@@ -0,0 +1,83 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "trie/StringBuffer.hpp"
+#include "trie/TrieFile.hpp"
+#include "trie/TriePatch.hpp"
+
+namespace trie {
+
+TriePatch::TriePatch(size_t firstStringIndex) : m_firstStringIndex{firstStringIndex} {
+}
+
+size_t TriePatch::getFirstStringIndex() const {
+  return m_firstStringIndex;
+}
+
+const StringBuffer& TriePatch::getInsertedStrings() const {
+  return m_insertedStrings;
+}
+
+const StringBuffer& TriePatch::getDeletedStrings() const {
+  return m_deletedStrings;
+}
+
+void TriePatch::insertString(const std::string& string) {
+  m_insertedStrings.append(string);
+}
+
+void TriePatch::deleteString(const std::string& string) {
+  m_deletedStrings.append(string);
+}
+
+void TriePatch::save(const std::string& path) const {
+  std::vector<std::string> sections(2U);
+  TrieFile::appendVarint(m_firstStringIndex, sections[0U]);
+  TrieFile::encodeStrings(m_insertedStrings, sections[0U]);
+  TrieFile::encodeStrings(m_deletedStrings, sections[1U]);
+  TrieFile::write(path, TrieFile::FileType::patch,
+      {TrieFile::SectionType::insertedStrings, TrieFile::SectionType::deletedStrings}, sections);
+}
+
+TriePatch TriePatch::load(const std::string& path) {
+  TrieFile file{path, TrieFile::FileType::patch};
+  const std::vector<std::string> sections{file.readAllSections()};
+  // the first string index is read from the section of the inserted strings
+  TriePatch patch{0U};
+
+  for (size_t sectionIndex = 0U; sectionIndex < sections.size(); sectionIndex++) {
+    const std::string& section{sections[sectionIndex]};
+    size_t position{0U};
+
+    switch (file.getSectionType(sectionIndex)) {
+      case TrieFile::SectionType::insertedStrings: {
+        patch.m_firstStringIndex = TrieFile::readVarint(section, position);
+        patch.m_insertedStrings = TrieFile::decodeStrings(section, position);
+        break;
+      }
+      case TrieFile::SectionType::deletedStrings: {
+        patch.m_deletedStrings = TrieFile::decodeStrings(section, position);
+        break;
+      }
+      default: {
+        throw std::runtime_error("Unexpected section in patch file \"" + path + "\".");
+      }
+    }
+
+    if (position != section.size()) {
+      throw std::runtime_error("Unexpected trailing data in patch file \"" + path + "\".");
+    }
+  }
+
+  return patch;
+}
+
+}  // namespace trie
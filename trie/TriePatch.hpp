@@ -0,0 +1,45 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_TRIEPATCH_HPP
+#define TRIE_TRIEPATCH_HPP
+
+#include <string>
+
+#include "trie/StringBuffer.hpp"
+
+namespace trie {
+
+// Small set of changes to a trie file, applied when loading the trie (Trie::load merges the
+// changes into the nodes in place, FrozenTrie::load freezes the trie again). Inserted strings get
+// consecutive string indices starting at firstStringIndex, deleted strings are identified by
+// their characters. For tries that own their strings, firstStringIndex has to be the number of
+// strings of the trie; for other tries, the indices of the inserted strings must not be stored
+// in the trie yet.
+class TriePatch {
+  public:
+    explicit TriePatch(size_t firstStringIndex);
+
+    size_t getFirstStringIndex() const;
+    const StringBuffer& getInsertedStrings() const;
+    const StringBuffer& getDeletedStrings() const;
+
+    void insertString(const std::string& string);
+    void deleteString(const std::string& string);
+
+    void save(const std::string& path) const;
+    static TriePatch load(const std::string& path);
+
+  private:
+    size_t m_firstStringIndex;
+    StringBuffer m_insertedStrings;
+    StringBuffer m_deletedStrings;
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_TRIEPATCH_HPP
@@ -0,0 +1,94 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "trie/FrozenTrie.hpp"
+#include "trie/Trie.hpp"
+#include "trie/WordPrefixIndex.hpp"
+
+namespace trie {
+
+constexpr const char* WordPrefixIndex::DEFAULT_SEPARATORS;
+
+WordPrefixIndex::WordPrefixIndex(
+      const std::vector<std::string>& strings,
+      const std::string& separators,
+      size_t parallelPrefixLength) : m_numberOfStrings{strings.size()} {
+  std::vector<std::string> suffixes;
+  // string index for each suffix
+  std::vector<size_t> suffixStringIndices;
+
+  for (size_t stringIndex = 0U; stringIndex < strings.size(); stringIndex++) {
+    const std::string& string{strings[stringIndex]};
+
+    for (size_t characterIndex = 0U; characterIndex < string.length(); characterIndex++) {
+      const bool isWordBegin{
+          (separators.find(string[characterIndex]) == std::string::npos)
+          && ((characterIndex == 0U)
+            || (separators.find(string[characterIndex - 1U]) != std::string::npos))};
+
+      if (isWordBegin) {
+        suffixes.push_back(string.substr(characterIndex));
+        suffixStringIndices.push_back(stringIndex);
+      }
+    }
+  }
+
+  m_suffixTrie = Trie{suffixes, parallelPrefixLength}.freeze();
+
+  // the trie stores equal suffixes only once, so the postings are grouped by the ID of the
+  // suffix (counting sort, which keeps the postings of each ID in ascending order)
+  std::vector<size_t> suffixIds(suffixes.size());
+  m_postingOffsets.assign(m_suffixTrie.getNumberOfStrings() + 1U, 0U);
+
+  for (size_t suffixIndex = 0U; suffixIndex < suffixes.size(); suffixIndex++) {
+    suffixIds[suffixIndex] = m_suffixTrie.encode(suffixes[suffixIndex]);
+    m_postingOffsets[suffixIds[suffixIndex] + 1U]++;
+  }
+
+  suffixes.clear();
+  suffixes.shrink_to_fit();
+
+  for (size_t id = 0U; id < m_suffixTrie.getNumberOfStrings(); id++) {
+    m_postingOffsets[id + 1U] += m_postingOffsets[id];
+  }
+
+  std::vector<size_t> postingPositions(
+      std::begin(m_postingOffsets), std::end(m_postingOffsets) - 1);
+  m_postings.resize(suffixIds.size());
+
+  for (size_t suffixIndex = 0U; suffixIndex < suffixIds.size(); suffixIndex++) {
+    m_postings[postingPositions[suffixIds[suffixIndex]]++] = suffixStringIndices[suffixIndex];
+  }
+}
+
+size_t WordPrefixIndex::getNumberOfStrings() const {
+  return m_numberOfStrings;
+}
+
+size_t WordPrefixIndex::getNumberOfSuffixes() const {
+  return m_postings.size();
+}
+
+std::vector<size_t> WordPrefixIndex::searchPrefix(const std::string& prefix) const {
+  const std::pair<size_t, size_t> idRange{m_suffixTrie.getIdRangeForPrefix(prefix)};
+  std::vector<size_t> stringIndices(
+      std::begin(m_postings) + static_cast<std::ptrdiff_t>(m_postingOffsets[idRange.first]),
+      std::begin(m_postings) + static_cast<std::ptrdiff_t>(m_postingOffsets[idRange.second]));
+
+  // a string matches once for every word that starts with prefix
+  std::sort(std::begin(stringIndices), std::end(stringIndices));
+  stringIndices.erase(std::unique(std::begin(stringIndices), std::end(stringIndices)),
+      std::end(stringIndices));
+  return stringIndices;
+}
+
+}  // namespace trie
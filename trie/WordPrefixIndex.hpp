@@ -0,0 +1,51 @@
+/* Copyright (C) 2021 Julian Valentin
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at https://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TRIE_WORDPREFIXINDEX_HPP
+#define TRIE_WORDPREFIXINDEX_HPP
+
+#include <string>
+#include <vector>
+
+#include "trie/FrozenTrie.hpp"
+
+namespace trie {
+
+// Index for prefix searches at word boundaries in multi-word strings (e.g., "yor" matches
+// "new york city"). Every suffix of a string that starts at the beginning of a word is stored
+// in a frozen trie. Equal suffixes of different strings share one trie entry, whose postings
+// are the indices of these strings. A prefix search takes one descent, and the postings of the
+// matching entries form one contiguous range, as the entries are numbered by their IDs.
+class WordPrefixIndex {
+  public:
+    explicit WordPrefixIndex(
+        const std::vector<std::string>& strings,
+        const std::string& separators = DEFAULT_SEPARATORS,
+        size_t parallelPrefixLength = 2U);
+
+    size_t getNumberOfStrings() const;
+    size_t getNumberOfSuffixes() const;
+
+    // returns the string indices (in ascending order and without duplicates) of the strings
+    // that contain a word starting with prefix (prefix may extend over following words;
+    // strings without words never match)
+    std::vector<size_t> searchPrefix(const std::string& prefix) const;
+
+    static constexpr const char* DEFAULT_SEPARATORS = " ";
+
+  private:
+    size_t m_numberOfStrings{0U};
+    FrozenTrie m_suffixTrie;
+    // the postings of the suffix with ID i are stored in the range from m_postingOffsets[i] to
+    // m_postingOffsets[i + 1] (exclusive), in ascending order
+    std::vector<size_t> m_postingOffsets;
+    std::vector<size_t> m_postings;
+};
+
+}  // namespace trie
+
+#endif  // #ifndef TRIE_WORDPREFIXINDEX_HPP